@@ -26,9 +26,250 @@
  * @brief API overview
  */
 
+#include <stddef.h>
 #include <can_netlink.h>
+#include <linux/if_link.h>
 
-struct rtnl_link_stats64; /* from <linux/if_link.h> */
+struct can_handle; /* opaque netlink handle */
+
+/*
+ * Presence bits of struct can_link_info
+ */
+#define CAN_LINK_INFO_STATE			0x0001
+#define CAN_LINK_INFO_RESTART_MS		0x0002
+#define CAN_LINK_INFO_BITTIMING			0x0004
+#define CAN_LINK_INFO_CTRLMODE			0x0008
+#define CAN_LINK_INFO_CLOCK			0x0010
+#define CAN_LINK_INFO_BITTIMING_CONST		0x0020
+#define CAN_LINK_INFO_BERR_COUNTER		0x0040
+#define CAN_LINK_INFO_DATA_BITTIMING		0x0080
+#define CAN_LINK_INFO_DATA_BITTIMING_CONST	0x0100
+#define CAN_LINK_INFO_DEVICE_STATS		0x0200
+#define CAN_LINK_INFO_LINK_STATS		0x0400
+#define CAN_LINK_INFO_CTRLMODE_SUPPORTED	0x0800
+
+/*
+ * Snapshot of all CAN attributes of a link, taken from a single reply
+ */
+struct can_link_info {
+	__u32 valid;		/* CAN_LINK_INFO_* bits of the members present */
+	int ifindex;		/* Interface index */
+	char name[16];		/* Interface name (IFNAMSIZ) */
+	unsigned int flags;	/* IFF_* interface flags */
+	int state;		/* enum can_state */
+	__u32 restart_ms;
+	struct can_bittiming bittiming;
+	struct can_bittiming data_bittiming;
+	struct can_ctrlmode ctrlmode;
+	struct can_clock clock;
+	struct can_bittiming_const bittiming_const;
+	struct can_bittiming_const data_bittiming_const;
+	struct can_berr_counter berr_counter;
+	struct can_device_stats device_stats;
+	struct rtnl_link_stats64 link_stats;
+	__u32 ctrlmode_supported;	/* CAN_CTRLMODE_* flags the device supports */
+};
+
+/*
+ * Presence bits of struct can_caps
+ */
+#define CAN_CAPS_CLOCK				0x0001
+#define CAN_CAPS_BITTIMING_CONST		0x0002
+#define CAN_CAPS_DATA_BITTIMING_CONST		0x0004
+#define CAN_CAPS_CTRLMODE_SUPPORTED		0x0008
+
+/*
+ * Static capabilities of a CAN controller, fixed for the life of the device
+ */
+struct can_caps {
+	__u32 valid;		/* CAN_CAPS_* bits of the members present */
+	int ifindex;		/* Interface index */
+	struct can_clock clock;
+	struct can_bittiming_const bittiming_const;
+	struct can_bittiming_const data_bittiming_const;
+	__u32 ctrlmode_supported;	/* CAN_CTRLMODE_* flags the device supports */
+};
+
+/*
+ * Counters of the query coalescing of a handle
+ */
+struct can_coalesce_stats {
+	__u64 queries;		/* snapshots fetched from the kernel */
+	__u64 merged_in_flight;	/* calls which waited for a running query */
+	__u64 merged_fresh;	/* calls served within the freshness window */
+};
+
+/*
+ * Callback for enumerating links, return non-zero to stop the enumeration
+ */
+typedef int (*can_link_info_cb)(const struct can_link_info *info, void *data);
+
+/*
+ * Completion callback of the async API. err is 0 or a negative errno value,
+ * info is only set for completed can_async_get_link_info requests.
+ */
+typedef void (*can_async_cb)(struct can_handle *h, int seq, int err,
+			     const struct can_link_info *info, void *data);
+
+struct can_batch; /* opaque batch of modification requests */
+struct can_prepared; /* prebuilt modification request */
+
+/*
+ * Members of struct can_config to apply
+ */
+#define CAN_CONFIG_BITTIMING		0x01
+#define CAN_CONFIG_DATA_BITTIMING	0x02
+#define CAN_CONFIG_CTRLMODE		0x04
+#define CAN_CONFIG_RESTART_MS		0x08
+#define CAN_CONFIG_STATE		0x10
+
+/*
+ * Complete configuration of a can interface, see can_apply_config()
+ */
+struct can_config {
+	__u32 mask;		/* CAN_CONFIG_* bits of the members to apply */
+	struct can_bittiming bittiming;
+	struct can_bittiming data_bittiming;
+	struct can_ctrlmode ctrlmode;
+	__u32 restart_ms;
+	int up;			/* Desired admin state, 1 = up, 0 = down */
+};
+
+/*
+ * Stages of can_apply_config()
+ */
+#define CAN_CONFIG_STAGE_NONE	0	/* Nothing failed */
+#define CAN_CONFIG_STAGE_QUERY	1	/* Reading the current admin state */
+#define CAN_CONFIG_STAGE_DOWN	2	/* Taking the interface down */
+#define CAN_CONFIG_STAGE_APPLY	3	/* Applying parameters and admin state */
+
+/*
+ * Result of the joint CAN FD bit-timing calculation
+ */
+struct can_fd_timing {
+	struct can_bittiming bittiming;		/* nominal phase */
+	struct can_bittiming data_bittiming;	/* data phase */
+	__u32 bitrate_error;		/* nominal bitrate error in ppm */
+	__u32 data_bitrate_error;	/* data bitrate error in ppm */
+	__u32 tdco;	/* suggested TDC offset in clock periods, 0 if n/a */
+};
+
+/*
+ * Frame format assumed by the bus-load estimation
+ */
+#define CAN_BUSLOAD_EXTENDED	0x1	/* 29 bit identifiers */
+#define CAN_BUSLOAD_FD		0x2	/* CAN FD frames */
+
+/*
+ * Bus-load estimate of an interval, in percent of the bus time
+ */
+struct can_busload {
+	__u64 interval_us;	/* length of the interval */
+	__u64 frames;		/* frames in the interval */
+	__u64 bytes;		/* payload bytes in the interval */
+	double min;		/* without stuff bits */
+	double avg;		/* with the stuff bits of random content */
+	double max;		/* with the most stuff bits possible */
+};
+
+struct can_monitor; /* opaque link monitor */
+
+/*
+ * Link monitor events
+ */
+#define CAN_MONITOR_NEWLINK	1	/* Link appeared or changed */
+#define CAN_MONITOR_DELLINK	2	/* Link disappeared */
+
+/*
+ * Callback for link monitor events. old_info is NULL if the link was not
+ * known before, new_info holds the decoded notification.
+ */
+typedef void (*can_monitor_cb)(int event, const struct can_link_info *old_info,
+			       const struct can_link_info *new_info, void *data);
+
+struct can_supervisor; /* opaque bus-off supervisor */
+
+/*
+ * Restart policy of the bus-off supervisor, all zero restarts at once and
+ * without limit
+ */
+struct can_supervisor_opts {
+	__u32 backoff_ms;	/* delay of the restart after a bus-off */
+	__u32 backoff_max_ms;	/* the delay doubles up to this, 0: no doubling */
+	__u32 stable_ms;	/* time without bus-off which resets the delay */
+	__u32 budget;		/* restarts per budget window, 0: unlimited */
+	__u32 budget_ms;	/* budget window, 0: budget for the lifetime */
+};
+
+/*
+ * Recovery record of a supervised link
+ */
+struct can_recovery {
+	int ifindex;		/* Interface index */
+	char name[16];		/* Interface name (IFNAMSIZ) */
+	int state;		/* last known enum can_state */
+	__u32 bus_offs;		/* bus-off events seen */
+	__u32 restarts;		/* restarts requested */
+	__u32 restart_errors;	/* restarts rejected by the kernel */
+	__u32 recoveries;	/* returns from bus-off to an active state */
+	__u32 delay_ms;		/* delay of the next restart */
+	int given_up;		/* budget exhausted, see can_supervisor_rearm */
+	__u64 last_us;		/* time to recovery of the last bus-off */
+	__u64 max_us;		/* longest time to recovery */
+	__u64 total_us;		/* sum of all times to recovery */
+};
+
+/*
+ * Bus-off supervisor events
+ */
+#define CAN_SUPERVISOR_BUS_OFF		1	/* Link went bus-off */
+#define CAN_SUPERVISOR_RESTART		2	/* Restart requested */
+#define CAN_SUPERVISOR_RESTART_FAILED	3	/* Restart rejected */
+#define CAN_SUPERVISOR_RECOVERED	4	/* Link left bus-off */
+#define CAN_SUPERVISOR_GIVE_UP		5	/* Budget exhausted */
+
+/*
+ * Callback for bus-off supervisor events, rec holds the updated record
+ */
+typedef void (*can_supervisor_cb)(int event, const struct can_recovery *rec,
+				  void *data);
+
+struct can_publisher; /* opaque shared memory snapshot publisher */
+struct can_reader; /* opaque reader of published snapshots */
+
+/* shared memory object of the snapshot publisher, see canpublishd */
+#define CAN_PUBLISH_DEFAULT	"/libsocketcan"
+
+struct can_sampler; /* opaque link statistics sampler */
+
+/*
+ * Sample of the link statistics sampler. The statistics are the increments
+ * since the previous sample, the error counters are the current levels.
+ */
+struct can_sample {
+	__u32 valid;		/* CAN_LINK_INFO_* bits of the members present */
+	int state;		/* enum can_state */
+	__u64 time_us;		/* CLOCK_MONOTONIC time of the sample */
+	__u64 interval_us;	/* time since the previous sample */
+	struct rtnl_link_stats64 link_stats;
+	struct can_device_stats device_stats;
+	struct can_berr_counter berr_counter;
+};
+
+/*
+ * Rates of a link, computed from the last samples
+ */
+struct can_rates {
+	__u64 interval_us;	/* time the rates are computed over */
+	double rx_frames;	/* frames/s */
+	double tx_frames;	/* frames/s */
+	double rx_bytes;	/* bytes/s */
+	double tx_bytes;	/* bytes/s */
+	double rx_errors;	/* errors/s */
+	double tx_errors;	/* errors/s */
+	double bus_errors;	/* bus errors/s */
+	double restarts;	/* restarts/min */
+};
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,6 +298,155 @@ int can_get_data_bittiming_const(const char *name, struct can_bittiming_const *d
 int can_get_berr_counter(const char *name, struct can_berr_counter *bc);
 int can_get_device_stats(const char *name, struct can_device_stats *cds);
 int can_get_link_stats(const char *name, struct rtnl_link_stats64 *rls);
+int can_get_stats(const char *name, struct rtnl_link_stats64 *rls, struct can_device_stats *cds);
+int can_get_link_info(const char *name, struct can_link_info *info);
+int can_get_caps(const char *name, struct can_caps *caps);
+int can_get_all_link_info(struct can_link_info *infos, int max);
+int can_apply_config(const char *name, const struct can_config *cfg, int *stage);
+int can_switch_bittiming(const char *name, struct can_bittiming *bt, struct can_bittiming *dbt, int timeout_ms, __u32 *offline_us);
+int can_switch_bitrate(const char *name, __u32 bitrate, __u32 dbitrate, int timeout_ms, __u32 *offline_us);
+int can_foreach_link(can_link_info_cb cb, void *data);
+
+struct can_handle *can_handle_open(void);
+void can_handle_close(struct can_handle *h);
+int can_handle_set_rxbuf(struct can_handle *h, void *buf, size_t size);
+const char *can_handle_get_error_msg(struct can_handle *h);
+
+int can_handle_do_restart(struct can_handle *h, const char *name);
+int can_handle_do_stop(struct can_handle *h, const char *name);
+int can_handle_do_start(struct can_handle *h, const char *name);
+
+int can_handle_set_restart_ms(struct can_handle *h, const char *name, __u32 restart_ms);
+int can_handle_set_bittiming(struct can_handle *h, const char *name, struct can_bittiming *bt);
+int can_handle_set_canfd_bittiming(struct can_handle *h, const char *name, struct can_bittiming *bt, struct can_bittiming *dbt);
+int can_handle_set_ctrlmode(struct can_handle *h, const char *name, struct can_ctrlmode *cm);
+int can_handle_set_bitrate(struct can_handle *h, const char *name, __u32 bitrate);
+int can_handle_set_bitrate_samplepoint(struct can_handle *h, const char *name, __u32 bitrate, __u32 sample_point);
+int can_handle_set_canfd_bitrates_samplepoint(struct can_handle *h, const char *name, __u32 bitrate, __u32 sample_point, __u32 dbitrate, __u32 dsample_point);
+
+int can_handle_get_restart_ms(struct can_handle *h, const char *name, __u32 *restart_ms);
+int can_handle_get_bittiming(struct can_handle *h, const char *name, struct can_bittiming *bt);
+int can_handle_get_data_bittiming(struct can_handle *h, const char *name, struct can_bittiming *dbt);
+int can_handle_get_ctrlmode(struct can_handle *h, const char *name, struct can_ctrlmode *cm);
+int can_handle_get_state(struct can_handle *h, const char *name, int *state);
+int can_handle_get_clock(struct can_handle *h, const char *name, struct can_clock *clock);
+int can_handle_get_bittiming_const(struct can_handle *h, const char *name, struct can_bittiming_const *btc);
+int can_handle_get_data_bittiming_const(struct can_handle *h, const char *name, struct can_bittiming_const *dbtc);
+int can_handle_get_berr_counter(struct can_handle *h, const char *name, struct can_berr_counter *bc);
+int can_handle_get_device_stats(struct can_handle *h, const char *name, struct can_device_stats *cds);
+int can_handle_get_link_stats(struct can_handle *h, const char *name, struct rtnl_link_stats64 *rls);
+int can_handle_get_stats(struct can_handle *h, const char *name, struct rtnl_link_stats64 *rls, struct can_device_stats *cds);
+int can_handle_get_link_info(struct can_handle *h, const char *name, struct can_link_info *info);
+int can_handle_get_caps(struct can_handle *h, const char *name, struct can_caps *caps);
+int can_handle_get_all_link_info(struct can_handle *h, struct can_link_info *infos, int max);
+int can_handle_apply_config(struct can_handle *h, const char *name, const struct can_config *cfg, int *stage);
+int can_handle_switch_bittiming(struct can_handle *h, const char *name, struct can_bittiming *bt, struct can_bittiming *dbt, int timeout_ms, __u32 *offline_us);
+int can_handle_switch_bitrate(struct can_handle *h, const char *name, __u32 bitrate, __u32 dbitrate, int timeout_ms, __u32 *offline_us);
+int can_handle_foreach_link(struct can_handle *h, can_link_info_cb cb, void *data);
+
+int can_handle_name_cache(struct can_handle *h, int enable);
+int can_handle_name_to_index(struct can_handle *h, const char *name);
+int can_handle_caps_cache(struct can_handle *h, int enable);
+int can_handle_coalesce(struct can_handle *h, int enable, __u32 window_us);
+int can_handle_get_coalesce_stats(struct can_handle *h, struct can_coalesce_stats *stats);
+int can_handle_do_start_by_index(struct can_handle *h, int ifindex);
+int can_handle_do_stop_by_index(struct can_handle *h, int ifindex);
+int can_handle_do_restart_by_index(struct can_handle *h, int ifindex);
+int can_handle_set_restart_ms_by_index(struct can_handle *h, int ifindex, __u32 restart_ms);
+int can_handle_set_ctrlmode_by_index(struct can_handle *h, int ifindex, struct can_ctrlmode *cm);
+int can_handle_set_bittiming_by_index(struct can_handle *h, int ifindex, struct can_bittiming *bt);
+int can_handle_set_canfd_bittiming_by_index(struct can_handle *h, int ifindex, struct can_bittiming *bt, struct can_bittiming *dbt);
+int can_handle_set_bitrate_by_index(struct can_handle *h, int ifindex, __u32 bitrate);
+int can_handle_set_bitrate_samplepoint_by_index(struct can_handle *h, int ifindex, __u32 bitrate, __u32 sample_point);
+int can_handle_set_canfd_bitrates_samplepoint_by_index(struct can_handle *h, int ifindex, __u32 bitrate, __u32 sample_point, __u32 dbitrate, __u32 dsample_point);
+int can_handle_get_stats_by_index(struct can_handle *h, int ifindex, struct rtnl_link_stats64 *rls, struct can_device_stats *cds);
+int can_handle_get_state_by_index(struct can_handle *h, int ifindex, int *state);
+int can_handle_get_restart_ms_by_index(struct can_handle *h, int ifindex, __u32 *restart_ms);
+int can_handle_get_bittiming_by_index(struct can_handle *h, int ifindex, struct can_bittiming *bt);
+int can_handle_get_data_bittiming_by_index(struct can_handle *h, int ifindex, struct can_bittiming *dbt);
+int can_handle_get_ctrlmode_by_index(struct can_handle *h, int ifindex, struct can_ctrlmode *cm);
+int can_handle_get_clock_by_index(struct can_handle *h, int ifindex, struct can_clock *clock);
+int can_handle_get_bittiming_const_by_index(struct can_handle *h, int ifindex, struct can_bittiming_const *btc);
+int can_handle_get_data_bittiming_const_by_index(struct can_handle *h, int ifindex, struct can_bittiming_const *dbtc);
+int can_handle_get_berr_counter_by_index(struct can_handle *h, int ifindex, struct can_berr_counter *bc);
+int can_handle_get_device_stats_by_index(struct can_handle *h, int ifindex, struct can_device_stats *cds);
+int can_handle_get_link_stats_by_index(struct can_handle *h, int ifindex, struct rtnl_link_stats64 *rls);
+int can_handle_get_link_info_by_index(struct can_handle *h, int ifindex, struct can_link_info *info);
+int can_handle_get_caps_by_index(struct can_handle *h, int ifindex, struct can_caps *caps);
+
+int can_handle_fd(struct can_handle *h);
+int can_handle_dispatch(struct can_handle *h);
+int can_handle_pending(struct can_handle *h);
+
+int can_async_get_link_info(struct can_handle *h, const char *name, can_async_cb cb, void *data);
+int can_async_do_restart(struct can_handle *h, const char *name, can_async_cb cb, void *data);
+int can_async_do_stop(struct can_handle *h, const char *name, can_async_cb cb, void *data);
+int can_async_do_start(struct can_handle *h, const char *name, can_async_cb cb, void *data);
+int can_async_set_restart_ms(struct can_handle *h, const char *name, __u32 restart_ms, can_async_cb cb, void *data);
+int can_async_set_bittiming(struct can_handle *h, const char *name, struct can_bittiming *bt, can_async_cb cb, void *data);
+int can_async_set_canfd_bittiming(struct can_handle *h, const char *name, struct can_bittiming *bt, struct can_bittiming *dbt, can_async_cb cb, void *data);
+int can_async_set_ctrlmode(struct can_handle *h, const char *name, struct can_ctrlmode *cm, can_async_cb cb, void *data);
+
+struct can_batch *can_batch_new(void);
+void can_batch_free(struct can_batch *b);
+int can_batch_count(struct can_batch *b);
+int can_batch_do_stop(struct can_batch *b, const char *name);
+int can_batch_do_start(struct can_batch *b, const char *name);
+int can_batch_set_restart_ms(struct can_batch *b, const char *name, __u32 restart_ms);
+int can_batch_set_bittiming(struct can_batch *b, const char *name, struct can_bittiming *bt);
+int can_batch_set_canfd_bittiming(struct can_batch *b, const char *name, struct can_bittiming *bt, struct can_bittiming *dbt);
+int can_batch_set_ctrlmode(struct can_batch *b, const char *name, struct can_ctrlmode *cm);
+int can_batch_set_bitrate(struct can_batch *b, const char *name, __u32 bitrate);
+int can_batch_send(struct can_handle *h, struct can_batch *b);
+int can_batch_result(struct can_batch *b, int index);
+
+struct can_prepared *can_handle_prepare_do_start(struct can_handle *h, const char *name);
+struct can_prepared *can_handle_prepare_do_stop(struct can_handle *h, const char *name);
+struct can_prepared *can_handle_prepare_do_restart(struct can_handle *h, const char *name);
+struct can_prepared *can_handle_prepare_set_ctrlmode(struct can_handle *h, const char *name, struct can_ctrlmode *cm);
+int can_prepared_exec(struct can_prepared *p);
+void can_prepared_free(struct can_prepared *p);
+
+int can_calc_bittiming(const struct can_bittiming_const *btc, const struct can_clock *clock, __u32 bitrate, __u32 sample_point, __u32 sjw, struct can_bittiming *bt);
+int can_calc_canfd_bittiming(const struct can_bittiming_const *btc, const struct can_bittiming_const *dbtc, const struct can_clock *clock, __u32 bitrate, __u32 sample_point, __u32 dbitrate, __u32 dsample_point, struct can_fd_timing *res);
+int can_lookup_bittiming(const struct can_bittiming_const *btc, const struct can_clock *clock, __u32 bitrate, __u32 sample_point, struct can_bittiming *bt);
+int can_calc_busload(__u64 frames, __u64 bytes, __u64 interval_us, __u32 bitrate, __u32 dbitrate, __u32 flags, struct can_busload *load);
+
+struct can_monitor *can_monitor_open(can_monitor_cb cb, void *data);
+void can_monitor_close(struct can_monitor *mon);
+int can_monitor_fd(struct can_monitor *mon);
+int can_monitor_dispatch(struct can_monitor *mon);
+int can_monitor_resync(struct can_monitor *mon);
+int can_monitor_get_link_info(struct can_monitor *mon, const char *name, struct can_link_info *info);
+
+struct can_supervisor *can_supervisor_open(const struct can_supervisor_opts *opts, can_supervisor_cb cb, void *data);
+void can_supervisor_close(struct can_supervisor *sup);
+int can_supervisor_fd(struct can_supervisor *sup);
+int can_supervisor_timeout(struct can_supervisor *sup);
+int can_supervisor_dispatch(struct can_supervisor *sup);
+int can_supervisor_get_recovery(struct can_supervisor *sup, const char *name, struct can_recovery *rec);
+int can_supervisor_rearm(struct can_supervisor *sup, const char *name);
+
+struct can_sampler *can_sampler_open(__u32 interval_ms, int depth);
+void can_sampler_close(struct can_sampler *s);
+int can_sampler_timeout(struct can_sampler *s);
+int can_sampler_dispatch(struct can_sampler *s);
+int can_sampler_sample(struct can_sampler *s);
+int can_sampler_get_history(struct can_sampler *s, const char *name, struct can_sample *samples, int max);
+int can_sampler_get_rates(struct can_sampler *s, const char *name, int n, struct can_rates *rates);
+int can_sampler_get_busload(struct can_sampler *s, const char *name, int n, __u32 flags, struct can_busload *load);
+
+struct can_publisher *can_publisher_open(const char *shm_name, int max_links, __u32 interval_ms);
+void can_publisher_close(struct can_publisher *pub);
+int can_publisher_fd(struct can_publisher *pub);
+int can_publisher_timeout(struct can_publisher *pub);
+int can_publisher_dispatch(struct can_publisher *pub);
+
+struct can_reader *can_reader_open(const char *shm_name);
+void can_reader_close(struct can_reader *r);
+int can_reader_get_link_info(struct can_reader *r, const char *name, struct can_link_info *info);
+int can_reader_get_all_link_info(struct can_reader *r, struct can_link_info *infos, int max);
+int can_reader_age_ms(struct can_reader *r);
 
 #ifdef __cplusplus
 }
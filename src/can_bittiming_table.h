@@ -0,0 +1,275 @@
+/* can_bittiming_table.h - generated by gen_bittiming_table, do not edit */
+
+/* precalculated bit timing, bt in the form the kernel accepts */
+struct bittiming_table_entry {
+	unsigned int btc;	/* index into bittiming_table_btc */
+	__u32 freq;
+	__u32 bitrate;
+	__u32 sample_point;
+	struct can_bittiming bt;
+};
+
+static const struct can_bittiming_const bittiming_table_btc[] = {
+	{ "mcp251x", 3, 16, 2, 8, 4, 1, 64, 1 },
+	{ "flexcan", 4, 16, 2, 8, 4, 1, 256, 1 },
+	{ "m_can", 2, 64, 1, 16, 16, 1, 1024, 1 },
+	{ "m_can", 1, 16, 1, 8, 4, 1, 32, 1 },
+	{ "m_can", 2, 256, 2, 128, 128, 1, 512, 1 },
+	{ "m_can", 1, 32, 1, 16, 16, 1, 32, 1 },
+};
+
+static const struct bittiming_table_entry bittiming_table[] = {
+	/* btc, clock, bitrate, sample_point, { bitrate, sample_point, tq, prop_seg, phase_seg1, phase_seg2, sjw, brp } */
+	{ 0, 8000000, 125000, 750, { 0, 750, 500, 5, 6, 4, 4, 4 } },
+	{ 0, 8000000, 125000, 800, { 0, 812, 500, 6, 6, 3, 3, 4 } },
+	{ 0, 8000000, 125000, 875, { 0, 875, 500, 6, 7, 2, 2, 4 } },
+	{ 0, 8000000, 250000, 750, { 0, 750, 250, 5, 6, 4, 4, 2 } },
+	{ 0, 8000000, 250000, 800, { 0, 812, 250, 6, 6, 3, 3, 2 } },
+	{ 0, 8000000, 250000, 875, { 0, 875, 250, 6, 7, 2, 2, 2 } },
+	{ 0, 8000000, 500000, 750, { 0, 750, 125, 5, 6, 4, 4, 1 } },
+	{ 0, 8000000, 500000, 800, { 0, 812, 125, 6, 6, 3, 3, 1 } },
+	{ 0, 8000000, 500000, 875, { 0, 875, 125, 6, 7, 2, 2, 1 } },
+	{ 0, 8000000, 800000, 750, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 0, 8000000, 800000, 800, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 0, 8000000, 800000, 875, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 0, 8000000, 1000000, 750, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 0, 8000000, 1000000, 800, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 0, 8000000, 1000000, 875, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 0, 40000000, 125000, 750, { 0, 750, 400, 7, 7, 5, 4, 16 } },
+	{ 0, 40000000, 125000, 800, { 0, 800, 400, 7, 8, 4, 4, 16 } },
+	{ 0, 40000000, 125000, 875, { 0, 875, 500, 6, 7, 2, 2, 20 } },
+	{ 0, 40000000, 250000, 750, { 0, 750, 200, 7, 7, 5, 4, 8 } },
+	{ 0, 40000000, 250000, 800, { 0, 800, 200, 7, 8, 4, 4, 8 } },
+	{ 0, 40000000, 250000, 875, { 0, 875, 250, 6, 7, 2, 2, 10 } },
+	{ 0, 40000000, 500000, 750, { 0, 750, 100, 7, 7, 5, 4, 4 } },
+	{ 0, 40000000, 500000, 800, { 0, 800, 100, 7, 8, 4, 4, 4 } },
+	{ 0, 40000000, 500000, 875, { 0, 875, 125, 6, 7, 2, 2, 5 } },
+	{ 0, 40000000, 800000, 750, { 0, 800, 125, 3, 4, 2, 2, 5 } },
+	{ 0, 40000000, 800000, 800, { 0, 800, 125, 3, 4, 2, 2, 5 } },
+	{ 0, 40000000, 800000, 875, { 0, 800, 125, 3, 4, 2, 2, 5 } },
+	{ 0, 40000000, 1000000, 750, { 0, 750, 50, 7, 7, 5, 4, 2 } },
+	{ 0, 40000000, 1000000, 800, { 0, 800, 50, 7, 8, 4, 4, 2 } },
+	{ 0, 40000000, 1000000, 875, { 0, 850, 50, 8, 8, 3, 3, 2 } },
+	{ 0, 80000000, 125000, 750, { 0, 750, 400, 7, 7, 5, 4, 32 } },
+	{ 0, 80000000, 125000, 800, { 0, 800, 400, 7, 8, 4, 4, 32 } },
+	{ 0, 80000000, 125000, 875, { 0, 875, 500, 6, 7, 2, 2, 40 } },
+	{ 0, 80000000, 250000, 750, { 0, 750, 200, 7, 7, 5, 4, 16 } },
+	{ 0, 80000000, 250000, 800, { 0, 800, 200, 7, 8, 4, 4, 16 } },
+	{ 0, 80000000, 250000, 875, { 0, 875, 250, 6, 7, 2, 2, 20 } },
+	{ 0, 80000000, 500000, 750, { 0, 750, 100, 7, 7, 5, 4, 8 } },
+	{ 0, 80000000, 500000, 800, { 0, 800, 100, 7, 8, 4, 4, 8 } },
+	{ 0, 80000000, 500000, 875, { 0, 875, 125, 6, 7, 2, 2, 10 } },
+	{ 0, 80000000, 800000, 750, { 0, 750, 62, 7, 7, 5, 4, 5 } },
+	{ 0, 80000000, 800000, 800, { 0, 800, 62, 7, 8, 4, 4, 5 } },
+	{ 0, 80000000, 800000, 875, { 0, 850, 62, 8, 8, 3, 3, 5 } },
+	{ 0, 80000000, 1000000, 750, { 0, 750, 50, 7, 7, 5, 4, 4 } },
+	{ 0, 80000000, 1000000, 800, { 0, 800, 50, 7, 8, 4, 4, 4 } },
+	{ 0, 80000000, 1000000, 875, { 0, 875, 62, 6, 7, 2, 2, 5 } },
+	{ 1, 8000000, 125000, 750, { 0, 750, 500, 5, 6, 4, 4, 4 } },
+	{ 1, 8000000, 125000, 800, { 0, 812, 500, 6, 6, 3, 3, 4 } },
+	{ 1, 8000000, 125000, 875, { 0, 875, 500, 6, 7, 2, 2, 4 } },
+	{ 1, 8000000, 250000, 750, { 0, 750, 250, 5, 6, 4, 4, 2 } },
+	{ 1, 8000000, 250000, 800, { 0, 812, 250, 6, 6, 3, 3, 2 } },
+	{ 1, 8000000, 250000, 875, { 0, 875, 250, 6, 7, 2, 2, 2 } },
+	{ 1, 8000000, 500000, 750, { 0, 750, 125, 5, 6, 4, 4, 1 } },
+	{ 1, 8000000, 500000, 800, { 0, 812, 125, 6, 6, 3, 3, 1 } },
+	{ 1, 8000000, 500000, 875, { 0, 875, 125, 6, 7, 2, 2, 1 } },
+	{ 1, 8000000, 800000, 750, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 1, 8000000, 800000, 800, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 1, 8000000, 800000, 875, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 1, 8000000, 1000000, 750, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 1, 8000000, 1000000, 800, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 1, 8000000, 1000000, 875, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 1, 40000000, 125000, 750, { 0, 750, 400, 7, 7, 5, 4, 16 } },
+	{ 1, 40000000, 125000, 800, { 0, 800, 400, 7, 8, 4, 4, 16 } },
+	{ 1, 40000000, 125000, 875, { 0, 875, 500, 6, 7, 2, 2, 20 } },
+	{ 1, 40000000, 250000, 750, { 0, 750, 200, 7, 7, 5, 4, 8 } },
+	{ 1, 40000000, 250000, 800, { 0, 800, 200, 7, 8, 4, 4, 8 } },
+	{ 1, 40000000, 250000, 875, { 0, 875, 250, 6, 7, 2, 2, 10 } },
+	{ 1, 40000000, 500000, 750, { 0, 750, 100, 7, 7, 5, 4, 4 } },
+	{ 1, 40000000, 500000, 800, { 0, 800, 100, 7, 8, 4, 4, 4 } },
+	{ 1, 40000000, 500000, 875, { 0, 875, 125, 6, 7, 2, 2, 5 } },
+	{ 1, 40000000, 800000, 750, { 0, 800, 125, 3, 4, 2, 2, 5 } },
+	{ 1, 40000000, 800000, 800, { 0, 800, 125, 3, 4, 2, 2, 5 } },
+	{ 1, 40000000, 800000, 875, { 0, 800, 125, 3, 4, 2, 2, 5 } },
+	{ 1, 40000000, 1000000, 750, { 0, 750, 50, 7, 7, 5, 4, 2 } },
+	{ 1, 40000000, 1000000, 800, { 0, 800, 50, 7, 8, 4, 4, 2 } },
+	{ 1, 40000000, 1000000, 875, { 0, 850, 50, 8, 8, 3, 3, 2 } },
+	{ 1, 80000000, 125000, 750, { 0, 750, 400, 7, 7, 5, 4, 32 } },
+	{ 1, 80000000, 125000, 800, { 0, 800, 400, 7, 8, 4, 4, 32 } },
+	{ 1, 80000000, 125000, 875, { 0, 875, 500, 6, 7, 2, 2, 40 } },
+	{ 1, 80000000, 250000, 750, { 0, 750, 200, 7, 7, 5, 4, 16 } },
+	{ 1, 80000000, 250000, 800, { 0, 800, 200, 7, 8, 4, 4, 16 } },
+	{ 1, 80000000, 250000, 875, { 0, 875, 250, 6, 7, 2, 2, 20 } },
+	{ 1, 80000000, 500000, 750, { 0, 750, 100, 7, 7, 5, 4, 8 } },
+	{ 1, 80000000, 500000, 800, { 0, 800, 100, 7, 8, 4, 4, 8 } },
+	{ 1, 80000000, 500000, 875, { 0, 875, 125, 6, 7, 2, 2, 10 } },
+	{ 1, 80000000, 800000, 750, { 0, 750, 62, 7, 7, 5, 4, 5 } },
+	{ 1, 80000000, 800000, 800, { 0, 800, 62, 7, 8, 4, 4, 5 } },
+	{ 1, 80000000, 800000, 875, { 0, 850, 62, 8, 8, 3, 3, 5 } },
+	{ 1, 80000000, 1000000, 750, { 0, 750, 50, 7, 7, 5, 4, 4 } },
+	{ 1, 80000000, 1000000, 800, { 0, 800, 50, 7, 8, 4, 4, 4 } },
+	{ 1, 80000000, 1000000, 875, { 0, 875, 62, 6, 7, 2, 2, 5 } },
+	{ 2, 8000000, 125000, 750, { 0, 750, 125, 23, 24, 16, 16, 1 } },
+	{ 2, 8000000, 125000, 800, { 0, 796, 125, 25, 25, 13, 13, 1 } },
+	{ 2, 8000000, 125000, 875, { 0, 875, 125, 27, 28, 8, 8, 1 } },
+	{ 2, 8000000, 250000, 750, { 0, 750, 125, 11, 12, 8, 8, 1 } },
+	{ 2, 8000000, 250000, 800, { 0, 812, 125, 12, 13, 6, 6, 1 } },
+	{ 2, 8000000, 250000, 875, { 0, 875, 125, 13, 14, 4, 4, 1 } },
+	{ 2, 8000000, 500000, 750, { 0, 750, 125, 5, 6, 4, 4, 1 } },
+	{ 2, 8000000, 500000, 800, { 0, 812, 125, 6, 6, 3, 3, 1 } },
+	{ 2, 8000000, 500000, 875, { 0, 875, 125, 6, 7, 2, 2, 1 } },
+	{ 2, 8000000, 800000, 750, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 2, 8000000, 800000, 800, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 2, 8000000, 800000, 875, { 0, 900, 125, 4, 4, 1, 1, 1 } },
+	{ 2, 8000000, 1000000, 750, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 2, 8000000, 1000000, 800, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 2, 8000000, 1000000, 875, { 0, 875, 125, 3, 3, 1, 1, 1 } },
+	{ 2, 40000000, 125000, 750, { 0, 750, 125, 23, 24, 16, 16, 5 } },
+	{ 2, 40000000, 125000, 800, { 0, 800, 100, 31, 32, 16, 16, 4 } },
+	{ 2, 40000000, 125000, 875, { 0, 875, 125, 27, 28, 8, 8, 5 } },
+	{ 2, 40000000, 250000, 750, { 0, 750, 100, 14, 15, 10, 10, 4 } },
+	{ 2, 40000000, 250000, 800, { 0, 800, 50, 31, 32, 16, 16, 2 } },
+	{ 2, 40000000, 250000, 875, { 0, 875, 100, 17, 17, 5, 5, 4 } },
+	{ 2, 40000000, 500000, 750, { 0, 750, 50, 14, 15, 10, 10, 2 } },
+	{ 2, 40000000, 500000, 800, { 0, 800, 25, 31, 32, 16, 16, 1 } },
+	{ 2, 40000000, 500000, 875, { 0, 875, 50, 17, 17, 5, 5, 2 } },
+	{ 2, 40000000, 800000, 750, { 0, 760, 25, 18, 19, 12, 12, 1 } },
+	{ 2, 40000000, 800000, 800, { 0, 800, 25, 19, 20, 10, 10, 1 } },
+	{ 2, 40000000, 800000, 875, { 0, 880, 25, 21, 22, 6, 6, 1 } },
+	{ 2, 40000000, 1000000, 750, { 0, 750, 25, 14, 15, 10, 10, 1 } },
+	{ 2, 40000000, 1000000, 800, { 0, 800, 25, 15, 16, 8, 8, 1 } },
+	{ 2, 40000000, 1000000, 875, { 0, 875, 25, 17, 17, 5, 5, 1 } },
+	{ 2, 80000000, 125000, 750, { 0, 750, 125, 23, 24, 16, 16, 10 } },
+	{ 2, 80000000, 125000, 800, { 0, 800, 100, 31, 32, 16, 16, 8 } },
+	{ 2, 80000000, 125000, 875, { 0, 875, 125, 27, 28, 8, 8, 10 } },
+	{ 2, 80000000, 250000, 750, { 0, 750, 62, 23, 24, 16, 16, 5 } },
+	{ 2, 80000000, 250000, 800, { 0, 800, 50, 31, 32, 16, 16, 4 } },
+	{ 2, 80000000, 250000, 875, { 0, 875, 62, 27, 28, 8, 8, 5 } },
+	{ 2, 80000000, 500000, 750, { 0, 750, 50, 14, 15, 10, 10, 4 } },
+	{ 2, 80000000, 500000, 800, { 0, 800, 25, 31, 32, 16, 16, 2 } },
+	{ 2, 80000000, 500000, 875, { 0, 875, 50, 17, 17, 5, 5, 4 } },
+	{ 2, 80000000, 800000, 750, { 0, 750, 62, 7, 7, 5, 5, 5 } },
+	{ 2, 80000000, 800000, 800, { 0, 800, 25, 19, 20, 10, 10, 2 } },
+	{ 2, 80000000, 800000, 875, { 0, 880, 25, 21, 22, 6, 6, 2 } },
+	{ 2, 80000000, 1000000, 750, { 0, 750, 25, 14, 15, 10, 10, 2 } },
+	{ 2, 80000000, 1000000, 800, { 0, 800, 12, 31, 32, 16, 16, 1 } },
+	{ 2, 80000000, 1000000, 875, { 0, 875, 25, 17, 17, 5, 5, 2 } },
+	{ 3, 8000000, 1000000, 750, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 3, 8000000, 1000000, 800, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 3, 8000000, 1000000, 875, { 0, 875, 125, 3, 3, 1, 1, 1 } },
+	{ 3, 8000000, 2000000, 750, { 0, 750, 125, 1, 1, 1, 1, 1 } },
+	{ 3, 8000000, 2000000, 800, { 0, 750, 125, 1, 1, 1, 1, 1 } },
+	{ 3, 8000000, 2000000, 875, { 0, 750, 125, 1, 1, 1, 1, 1 } },
+	{ 3, 40000000, 1000000, 750, { 0, 750, 50, 7, 7, 5, 4, 2 } },
+	{ 3, 40000000, 1000000, 800, { 0, 800, 50, 7, 8, 4, 4, 2 } },
+	{ 3, 40000000, 1000000, 875, { 0, 875, 125, 3, 3, 1, 1, 5 } },
+	{ 3, 40000000, 2000000, 750, { 0, 750, 25, 7, 7, 5, 4, 1 } },
+	{ 3, 40000000, 2000000, 800, { 0, 800, 25, 7, 8, 4, 4, 1 } },
+	{ 3, 40000000, 2000000, 875, { 0, 850, 25, 8, 8, 3, 3, 1 } },
+	{ 3, 40000000, 4000000, 750, { 0, 800, 25, 3, 4, 2, 2, 1 } },
+	{ 3, 40000000, 4000000, 800, { 0, 800, 25, 3, 4, 2, 2, 1 } },
+	{ 3, 40000000, 4000000, 875, { 0, 900, 25, 4, 4, 1, 1, 1 } },
+	{ 3, 40000000, 5000000, 750, { 0, 750, 25, 2, 3, 2, 2, 1 } },
+	{ 3, 40000000, 5000000, 800, { 0, 750, 25, 2, 3, 2, 2, 1 } },
+	{ 3, 40000000, 5000000, 875, { 0, 875, 25, 3, 3, 1, 1, 1 } },
+	{ 3, 40000000, 8000000, 750, { 0, 800, 25, 1, 2, 1, 1, 1 } },
+	{ 3, 40000000, 8000000, 800, { 0, 800, 25, 1, 2, 1, 1, 1 } },
+	{ 3, 40000000, 8000000, 875, { 0, 800, 25, 1, 2, 1, 1, 1 } },
+	{ 3, 80000000, 1000000, 750, { 0, 750, 50, 7, 7, 5, 4, 4 } },
+	{ 3, 80000000, 1000000, 800, { 0, 800, 50, 7, 8, 4, 4, 4 } },
+	{ 3, 80000000, 1000000, 875, { 0, 875, 62, 6, 7, 2, 2, 5 } },
+	{ 3, 80000000, 2000000, 750, { 0, 750, 25, 7, 7, 5, 4, 2 } },
+	{ 3, 80000000, 2000000, 800, { 0, 800, 25, 7, 8, 4, 4, 2 } },
+	{ 3, 80000000, 2000000, 875, { 0, 875, 62, 3, 3, 1, 1, 5 } },
+	{ 3, 80000000, 4000000, 750, { 0, 750, 12, 7, 7, 5, 4, 1 } },
+	{ 3, 80000000, 4000000, 800, { 0, 800, 12, 7, 8, 4, 4, 1 } },
+	{ 3, 80000000, 4000000, 875, { 0, 850, 12, 8, 8, 3, 3, 1 } },
+	{ 3, 80000000, 5000000, 750, { 0, 750, 12, 5, 6, 4, 4, 1 } },
+	{ 3, 80000000, 5000000, 800, { 0, 812, 12, 6, 6, 3, 3, 1 } },
+	{ 3, 80000000, 5000000, 875, { 0, 875, 12, 6, 7, 2, 2, 1 } },
+	{ 3, 80000000, 8000000, 750, { 0, 800, 12, 3, 4, 2, 2, 1 } },
+	{ 3, 80000000, 8000000, 800, { 0, 800, 12, 3, 4, 2, 2, 1 } },
+	{ 3, 80000000, 8000000, 875, { 0, 900, 12, 4, 4, 1, 1, 1 } },
+	{ 4, 8000000, 125000, 750, { 0, 750, 125, 23, 24, 16, 16, 1 } },
+	{ 4, 8000000, 125000, 800, { 0, 796, 125, 25, 25, 13, 13, 1 } },
+	{ 4, 8000000, 125000, 875, { 0, 875, 125, 27, 28, 8, 8, 1 } },
+	{ 4, 8000000, 250000, 750, { 0, 750, 125, 11, 12, 8, 8, 1 } },
+	{ 4, 8000000, 250000, 800, { 0, 812, 125, 12, 13, 6, 6, 1 } },
+	{ 4, 8000000, 250000, 875, { 0, 875, 125, 13, 14, 4, 4, 1 } },
+	{ 4, 8000000, 500000, 750, { 0, 750, 125, 5, 6, 4, 4, 1 } },
+	{ 4, 8000000, 500000, 800, { 0, 812, 125, 6, 6, 3, 3, 1 } },
+	{ 4, 8000000, 500000, 875, { 0, 875, 125, 6, 7, 2, 2, 1 } },
+	{ 4, 8000000, 800000, 750, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 4, 8000000, 800000, 800, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 4, 8000000, 800000, 875, { 0, 800, 125, 3, 4, 2, 2, 1 } },
+	{ 4, 8000000, 1000000, 750, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 4, 8000000, 1000000, 800, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 4, 8000000, 1000000, 875, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 4, 40000000, 125000, 750, { 0, 750, 25, 119, 120, 80, 80, 1 } },
+	{ 4, 40000000, 125000, 800, { 0, 800, 25, 127, 128, 64, 64, 1 } },
+	{ 4, 40000000, 125000, 875, { 0, 875, 50, 69, 70, 20, 20, 2 } },
+	{ 4, 40000000, 250000, 750, { 0, 750, 25, 59, 60, 40, 40, 1 } },
+	{ 4, 40000000, 250000, 800, { 0, 800, 25, 63, 64, 32, 32, 1 } },
+	{ 4, 40000000, 250000, 875, { 0, 875, 25, 69, 70, 20, 20, 1 } },
+	{ 4, 40000000, 500000, 750, { 0, 750, 25, 29, 30, 20, 20, 1 } },
+	{ 4, 40000000, 500000, 800, { 0, 800, 25, 31, 32, 16, 16, 1 } },
+	{ 4, 40000000, 500000, 875, { 0, 875, 25, 34, 35, 10, 10, 1 } },
+	{ 4, 40000000, 800000, 750, { 0, 760, 25, 18, 19, 12, 12, 1 } },
+	{ 4, 40000000, 800000, 800, { 0, 800, 25, 19, 20, 10, 10, 1 } },
+	{ 4, 40000000, 800000, 875, { 0, 880, 25, 21, 22, 6, 6, 1 } },
+	{ 4, 40000000, 1000000, 750, { 0, 750, 25, 14, 15, 10, 10, 1 } },
+	{ 4, 40000000, 1000000, 800, { 0, 800, 25, 15, 16, 8, 8, 1 } },
+	{ 4, 40000000, 1000000, 875, { 0, 875, 25, 17, 17, 5, 5, 1 } },
+	{ 4, 80000000, 125000, 750, { 0, 750, 25, 119, 120, 80, 80, 2 } },
+	{ 4, 80000000, 125000, 800, { 0, 800, 25, 127, 128, 64, 64, 2 } },
+	{ 4, 80000000, 125000, 875, { 0, 875, 50, 69, 70, 20, 20, 4 } },
+	{ 4, 80000000, 250000, 750, { 0, 750, 12, 119, 120, 80, 80, 1 } },
+	{ 4, 80000000, 250000, 800, { 0, 800, 12, 127, 128, 64, 64, 1 } },
+	{ 4, 80000000, 250000, 875, { 0, 875, 25, 69, 70, 20, 20, 2 } },
+	{ 4, 80000000, 500000, 750, { 0, 750, 12, 59, 60, 40, 40, 1 } },
+	{ 4, 80000000, 500000, 800, { 0, 800, 12, 63, 64, 32, 32, 1 } },
+	{ 4, 80000000, 500000, 875, { 0, 875, 12, 69, 70, 20, 20, 1 } },
+	{ 4, 80000000, 800000, 750, { 0, 750, 12, 37, 37, 25, 25, 1 } },
+	{ 4, 80000000, 800000, 800, { 0, 800, 12, 39, 40, 20, 20, 1 } },
+	{ 4, 80000000, 800000, 875, { 0, 880, 12, 43, 44, 12, 12, 1 } },
+	{ 4, 80000000, 1000000, 750, { 0, 750, 12, 29, 30, 20, 20, 1 } },
+	{ 4, 80000000, 1000000, 800, { 0, 800, 12, 31, 32, 16, 16, 1 } },
+	{ 4, 80000000, 1000000, 875, { 0, 875, 12, 34, 35, 10, 10, 1 } },
+	{ 5, 8000000, 1000000, 750, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 5, 8000000, 1000000, 800, { 0, 750, 125, 2, 3, 2, 2, 1 } },
+	{ 5, 8000000, 1000000, 875, { 0, 875, 125, 3, 3, 1, 1, 1 } },
+	{ 5, 8000000, 2000000, 750, { 0, 750, 125, 1, 1, 1, 1, 1 } },
+	{ 5, 8000000, 2000000, 800, { 0, 750, 125, 1, 1, 1, 1, 1 } },
+	{ 5, 8000000, 2000000, 875, { 0, 750, 125, 1, 1, 1, 1, 1 } },
+	{ 5, 40000000, 1000000, 750, { 0, 750, 25, 14, 15, 10, 10, 1 } },
+	{ 5, 40000000, 1000000, 800, { 0, 800, 25, 15, 16, 8, 8, 1 } },
+	{ 5, 40000000, 1000000, 875, { 0, 875, 125, 3, 3, 1, 1, 5 } },
+	{ 5, 40000000, 2000000, 750, { 0, 750, 25, 7, 7, 5, 5, 1 } },
+	{ 5, 40000000, 2000000, 800, { 0, 800, 25, 7, 8, 4, 4, 1 } },
+	{ 5, 40000000, 2000000, 875, { 0, 900, 25, 8, 9, 2, 2, 1 } },
+	{ 5, 40000000, 4000000, 750, { 0, 800, 25, 3, 4, 2, 2, 1 } },
+	{ 5, 40000000, 4000000, 800, { 0, 800, 25, 3, 4, 2, 2, 1 } },
+	{ 5, 40000000, 4000000, 875, { 0, 900, 25, 4, 4, 1, 1, 1 } },
+	{ 5, 40000000, 5000000, 750, { 0, 750, 25, 2, 3, 2, 2, 1 } },
+	{ 5, 40000000, 5000000, 800, { 0, 750, 25, 2, 3, 2, 2, 1 } },
+	{ 5, 40000000, 5000000, 875, { 0, 875, 25, 3, 3, 1, 1, 1 } },
+	{ 5, 40000000, 8000000, 750, { 0, 800, 25, 1, 2, 1, 1, 1 } },
+	{ 5, 40000000, 8000000, 800, { 0, 800, 25, 1, 2, 1, 1, 1 } },
+	{ 5, 40000000, 8000000, 875, { 0, 800, 25, 1, 2, 1, 1, 1 } },
+	{ 5, 80000000, 1000000, 750, { 0, 750, 25, 14, 15, 10, 10, 2 } },
+	{ 5, 80000000, 1000000, 800, { 0, 800, 25, 15, 16, 8, 8, 2 } },
+	{ 5, 80000000, 1000000, 875, { 0, 875, 62, 6, 7, 2, 2, 5 } },
+	{ 5, 80000000, 2000000, 750, { 0, 750, 12, 14, 15, 10, 10, 1 } },
+	{ 5, 80000000, 2000000, 800, { 0, 800, 12, 15, 16, 8, 8, 1 } },
+	{ 5, 80000000, 2000000, 875, { 0, 875, 62, 3, 3, 1, 1, 5 } },
+	{ 5, 80000000, 4000000, 750, { 0, 750, 12, 7, 7, 5, 5, 1 } },
+	{ 5, 80000000, 4000000, 800, { 0, 800, 12, 7, 8, 4, 4, 1 } },
+	{ 5, 80000000, 4000000, 875, { 0, 900, 12, 8, 9, 2, 2, 1 } },
+	{ 5, 80000000, 5000000, 750, { 0, 750, 12, 5, 6, 4, 4, 1 } },
+	{ 5, 80000000, 5000000, 800, { 0, 812, 12, 6, 6, 3, 3, 1 } },
+	{ 5, 80000000, 5000000, 875, { 0, 875, 12, 6, 7, 2, 2, 1 } },
+	{ 5, 80000000, 8000000, 750, { 0, 800, 12, 3, 4, 2, 2, 1 } },
+	{ 5, 80000000, 8000000, 800, { 0, 800, 12, 3, 4, 2, 2, 1 } },
+	{ 5, 80000000, 8000000, 875, { 0, 900, 12, 4, 4, 1, 1, 1 } },
+};
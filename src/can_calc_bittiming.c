@@ -0,0 +1,494 @@
+/* can_calc_bittiming.c
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * @file
+ * @brief userspace bit-timing calculation
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "libsocketcan_config.h"
+#endif
+
+#include <string.h>
+#include <errno.h>
+
+#include <libsocketcan.h>
+
+/* maximum bitrate error in one-tenth of a percent, as the kernel allows */
+#define CAN_CALC_MAX_ERROR 50
+
+/* best prescaler and time segments found for one bitrate */
+struct calc_result {
+	__u32 tsegall;	/* time quanta per bit, including the sync segment */
+	__u32 brp;
+	__u32 tseg1;
+	__u32 tseg2;
+	__u32 rate_err;	/* absolute bitrate error */
+	__u32 sp_err;	/* sample point error in one-tenth of a percent */
+};
+
+#include "can_bittiming_table.h"
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/**
+ * @ingroup intern
+ * @brief abs_diff - absolute difference of two unsigned values
+ */
+static __u32 abs_diff(__u32 a, __u32 b)
+{
+	return a > b ? a - b : b - a;
+}
+
+/**
+ * @ingroup intern
+ * @brief default_sample_point - CiA recommended sample point for a bitrate
+ *
+ * @param bitrate bitrate of the can bus
+ *
+ * @return sample point in one-tenth of a percent
+ */
+static __u32 default_sample_point(__u32 bitrate)
+{
+	if (bitrate > 800000)
+		return 750;
+	if (bitrate > 500000)
+		return 800;
+
+	return 875;
+}
+
+/**
+ * @ingroup intern
+ * @brief split_tseg - split the time quanta of a bit into tseg1 and tseg2
+ *
+ * @param btc bit-timing constants of the controller
+ * @param tsegall number of time quanta per bit, including the sync segment
+ * @param sample_point wanted sample point in one-tenth of a percent
+ * @param tseg1 pointer to store tseg1
+ * @param tseg2 pointer to store tseg2
+ *
+ * Tries the two tseg2 values next to the ideal one and keeps the one with
+ * the smaller sample point error.
+ *
+ * @return sample point error in one-tenth of a percent
+ * @return -1 if no valid split exists
+ */
+static int split_tseg(const struct can_bittiming_const *btc, __u32 tsegall,
+		      __u32 sample_point, __u32 *tseg1, __u32 *tseg2)
+{
+	__u32 ideal = tsegall - (sample_point * tsegall + 999) / 1000;
+	int best_err = -1;
+	__u32 i;
+
+	for (i = 0; i < 2; i++) {
+		__u32 t2 = ideal + i;
+		__u32 t1, sp;
+		int err;
+
+		if (t2 < btc->tseg2_min)
+			t2 = btc->tseg2_min;
+		if (t2 > btc->tseg2_max)
+			t2 = btc->tseg2_max;
+		if (t2 + 1 >= tsegall)
+			continue;
+
+		t1 = tsegall - 1 - t2;
+		if (t1 > btc->tseg1_max) {
+			t1 = btc->tseg1_max;
+			t2 = tsegall - 1 - t1;
+			if (t2 > btc->tseg2_max)
+				continue;
+		}
+		if (t1 < btc->tseg1_min)
+			continue;
+
+		sp = 1000 * (tsegall - t2) / tsegall;
+		err = abs_diff(sp, sample_point);
+		if (best_err < 0 || err < best_err) {
+			best_err = err;
+			*tseg1 = t1;
+			*tseg2 = t2;
+		}
+	}
+
+	return best_err;
+}
+
+/**
+ * @ingroup intern
+ * @brief calc_tseg - find the best prescaler and time segments for a bitrate
+ *
+ * @param btc bit-timing constants of the controller
+ * @param freq clock frequency of the controller
+ * @param bitrate wanted bitrate
+ * @param sample_point wanted sample point in one-tenth of a percent
+ * @param brp_fixed prescaler to use, or 0 to choose it freely
+ * @param res pointer to store the result
+ *
+ * @return 0 if a timing within CAN_CALC_MAX_ERROR exists
+ * @return -1 otherwise
+ */
+static int calc_tseg(const struct can_bittiming_const *btc, __u32 freq,
+		     __u32 bitrate, __u32 sample_point, __u32 brp_fixed,
+		     struct calc_result *res)
+{
+	__u32 tsegall, tsegall_min, tsegall_max;
+	__u32 brp_inc = btc->brp_inc ? btc->brp_inc : 1;
+
+	res->tsegall = 0;
+	res->rate_err = ~0U;
+	res->sp_err = ~0U;
+
+	if (brp_fixed && (brp_fixed < btc->brp_min ||
+			  brp_fixed > btc->brp_max || brp_fixed % brp_inc))
+		return -1;
+
+	tsegall_min = 1 + btc->tseg1_min + btc->tseg2_min;
+	tsegall_max = 1 + btc->tseg1_max + btc->tseg2_max;
+
+	/* walk down, so that ties keep the finer resolution */
+	for (tsegall = tsegall_max; tsegall >= tsegall_min && tsegall; tsegall--) {
+		__u64 div = (__u64)tsegall * bitrate;
+		__u32 brp, rate, rate_err, tseg1, tseg2;
+		int sp_err;
+
+		if (brp_fixed) {
+			brp = brp_fixed;
+		} else {
+			/* nearest prescaler, aligned to brp_inc */
+			brp = (freq + div / 2) / div;
+			brp = (brp + brp_inc / 2) / brp_inc * brp_inc;
+			if (brp < btc->brp_min || brp > btc->brp_max || brp == 0)
+				continue;
+		}
+
+		rate = freq / ((__u64)brp * tsegall);
+		rate_err = abs_diff(rate, bitrate);
+		if (rate_err > res->rate_err)
+			continue;
+
+		sp_err = split_tseg(btc, tsegall, sample_point, &tseg1, &tseg2);
+		if (sp_err < 0)
+			continue;
+
+		if (rate_err == res->rate_err && (__u32)sp_err >= res->sp_err)
+			continue;
+
+		res->rate_err = rate_err;
+		res->sp_err = sp_err;
+		res->tsegall = tsegall;
+		res->brp = brp;
+		res->tseg1 = tseg1;
+		res->tseg2 = tseg2;
+
+		if (rate_err == 0 && sp_err == 0)
+			break;
+	}
+
+	if (res->tsegall == 0 ||
+	    (__u64)res->rate_err * 1000 / bitrate > CAN_CALC_MAX_ERROR)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief fill_bittiming - convert a calculation result to can_bittiming
+ *
+ * The kernel only takes a fully specified bit timing with bitrate 0, it
+ * derives the prescaler from tq then and fills in bitrate and sample point.
+ *
+ * @param btc bit-timing constants of the controller
+ * @param freq clock frequency of the controller
+ * @param res result of calc_tseg
+ * @param sjw wanted synchronisation jump width, or 0 for the largest possible
+ * @param bt pointer to store the bit timing
+ */
+static void fill_bittiming(const struct can_bittiming_const *btc, __u32 freq,
+			   const struct calc_result *res, __u32 sjw,
+			   struct can_bittiming *bt)
+{
+	memset(bt, 0, sizeof(*bt));
+	bt->brp = res->brp;
+	bt->prop_seg = res->tseg1 / 2;
+	bt->phase_seg1 = res->tseg1 - bt->prop_seg;
+	bt->phase_seg2 = res->tseg2;
+	bt->sample_point = 1000 * (res->tsegall - res->tseg2) / res->tsegall;
+	bt->tq = (__u64)res->brp * 1000000000 / freq;
+
+	if (sjw == 0)
+		sjw = res->tseg2;
+	if (sjw > btc->sjw_max)
+		sjw = btc->sjw_max;
+	if (sjw > res->tseg2)
+		sjw = res->tseg2;
+	if (sjw > bt->phase_seg1)
+		sjw = bt->phase_seg1;
+	bt->sjw = sjw ? sjw : 1;
+}
+
+/**
+ * @ingroup intern
+ * @brief rate_error_ppm - bitrate error relative to the wanted bitrate
+ */
+static __u32 rate_error_ppm(const struct calc_result *res, __u32 bitrate)
+{
+	return (__u64)res->rate_err * 1000000 / bitrate;
+}
+
+/**
+ * @ingroup extern
+ * can_calc_bittiming - calculate the bit timing in userspace
+ *
+ * @param btc bit-timing constants of the controller, see
+ * can_get_bittiming_const
+ * @param clock clock of the controller, see can_get_clock
+ * @param bitrate wanted bitrate of the can bus
+ * @param sample_point wanted sample point in one-tenth of a percent, or 0 for
+ * the CiA recommended value
+ * @param sjw wanted synchronisation jump width in time quanta, or 0 for the
+ * largest value the segments and the controller allow
+ * @param bt pointer to store the result
+ *
+ * This enumerates all valid combinations of prescaler and time segments the
+ * controller supports and picks the one with the smallest bitrate error,
+ * then the smallest sample point error, then the most time quanta per bit.
+ * The result is fully specified and can be passed to can_set_bittiming, so
+ * the kernel does not need CONFIG_CAN_CALC_BITTIMING and an unreachable
+ * bitrate is detected before talking to the kernel at all.
+ *
+ * As the kernel requires for a fully specified bit timing, bt->bitrate is 0
+ * and bt->tq is set. bt->sample_point holds the sample point actually
+ * reached, the bitrate actually reached is clock->freq / (bt->brp *
+ * (1 + bt->prop_seg + bt->phase_seg1 + bt->phase_seg2)).
+ *
+ * The calculation only loops over the possible numbers of time quanta per
+ * bit, so sweeping all standard bitrates for many controllers is cheap.
+ *
+ * @return 0 if success
+ * @return -1 if no timing within 5% of the bitrate exists, errno is set to
+ * ERANGE then, or EINVAL for invalid parameters
+ */
+int can_calc_bittiming(const struct can_bittiming_const *btc,
+		       const struct can_clock *clock, __u32 bitrate,
+		       __u32 sample_point, __u32 sjw, struct can_bittiming *bt)
+{
+	struct calc_result res;
+
+	if (bitrate == 0 || clock->freq == 0 || sample_point >= 1000) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (sample_point == 0)
+		sample_point = default_sample_point(bitrate);
+
+	if (calc_tseg(btc, clock->freq, bitrate, sample_point, 0, &res) < 0) {
+		errno = ERANGE;
+		return -1;
+	}
+
+	fill_bittiming(btc, clock->freq, &res, sjw, bt);
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_calc_canfd_bittiming - calculate nominal and data bit timing jointly
+ *
+ * @param btc nominal bit-timing constants of the controller, see
+ * can_get_bittiming_const
+ * @param dbtc data bit-timing constants of the controller, see
+ * can_get_data_bittiming_const
+ * @param clock clock of the controller, see can_get_clock
+ * @param bitrate wanted nominal bitrate
+ * @param sample_point wanted nominal sample point in one-tenth of a percent,
+ * or 0 for the CiA recommended value
+ * @param dbitrate wanted data bitrate
+ * @param dsample_point wanted data sample point in one-tenth of a percent, or
+ * 0 for the CiA recommended value
+ * @param res pointer to store the result
+ *
+ * Calculating both phases independently, as the kernel does, easily ends up
+ * with different prescalers for the nominal and the data phase. CiA 601
+ * recommends the same prescaler for both, as small as possible, so that the
+ * time quantum is the same and as short as possible while the controller
+ * switches phases.
+ *
+ * This tries every prescaler both phases support, from the smallest up, and
+ * keeps the one with the smallest sum of the relative bitrate errors, then
+ * the smallest sum of the sample point errors. Only if no common prescaler
+ * reaches both bitrates within 5% are the phases calculated independently.
+ *
+ * res->tdco holds the transmitter delay compensation offset matching the
+ * data sample point, in clock periods. It is 0 if the data prescaler is
+ * larger than 2, where ISO 11898-1 does not use TDC.
+ *
+ * Both bit timings are in the form of can_calc_bittiming and can be passed
+ * to can_set_canfd_bittiming. res->bitrate_error and res->data_bitrate_error
+ * hold the deviation of the bitrates actually reached.
+ *
+ * The SJW of both phases is the largest value the segments allow.
+ *
+ * @return 0 if success
+ * @return -1 if a phase can not be reached within 5%, errno is set to
+ * ERANGE then, or EINVAL for invalid parameters
+ */
+int can_calc_canfd_bittiming(const struct can_bittiming_const *btc,
+			     const struct can_bittiming_const *dbtc,
+			     const struct can_clock *clock, __u32 bitrate,
+			     __u32 sample_point, __u32 dbitrate,
+			     __u32 dsample_point, struct can_fd_timing *res)
+{
+	struct calc_result nom, data, best_nom, best_data;
+	__u32 best_err = ~0U, best_sp_err = ~0U;
+	__u32 brp, brp_min, brp_max;
+
+	if (bitrate == 0 || dbitrate == 0 || clock->freq == 0 ||
+	    sample_point >= 1000 || dsample_point >= 1000) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (sample_point == 0)
+		sample_point = default_sample_point(bitrate);
+	if (dsample_point == 0)
+		dsample_point = default_sample_point(dbitrate);
+
+	brp_min = btc->brp_min > dbtc->brp_min ? btc->brp_min : dbtc->brp_min;
+	brp_max = btc->brp_max < dbtc->brp_max ? btc->brp_max : dbtc->brp_max;
+	if (brp_min == 0)
+		brp_min = 1;
+
+	for (brp = brp_min; brp <= brp_max; brp++) {
+		__u32 err, sp_err;
+
+		if (calc_tseg(dbtc, clock->freq, dbitrate, dsample_point,
+			      brp, &data) < 0)
+			continue;
+		if (calc_tseg(btc, clock->freq, bitrate, sample_point,
+			      brp, &nom) < 0)
+			continue;
+
+		err = (__u64)nom.rate_err * 1000000 / bitrate +
+			(__u64)data.rate_err * 1000000 / dbitrate;
+		sp_err = nom.sp_err + data.sp_err;
+		if (err > best_err || (err == best_err && sp_err >= best_sp_err))
+			continue;
+
+		best_err = err;
+		best_sp_err = sp_err;
+		best_nom = nom;
+		best_data = data;
+
+		if (err == 0 && sp_err == 0)
+			break;
+	}
+
+	if (best_err == ~0U) {
+		/* no common prescaler, fall back to independent phases */
+		if (calc_tseg(btc, clock->freq, bitrate, sample_point, 0,
+			      &best_nom) < 0 ||
+		    calc_tseg(dbtc, clock->freq, dbitrate, dsample_point, 0,
+			      &best_data) < 0) {
+			errno = ERANGE;
+			return -1;
+		}
+	}
+
+	memset(res, 0, sizeof(*res));
+	fill_bittiming(btc, clock->freq, &best_nom, 0, &res->bittiming);
+	fill_bittiming(dbtc, clock->freq, &best_data, 0, &res->data_bittiming);
+	res->bitrate_error = rate_error_ppm(&best_nom, bitrate);
+	res->data_bitrate_error = rate_error_ppm(&best_data, dbitrate);
+
+	/* TDC is only applicable if the data prescaler is one or two */
+	if (best_data.brp <= 2)
+		res->tdco = (best_data.tsegall - best_data.tseg2) * best_data.brp;
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_lookup_bittiming - look up a precalculated bit timing
+ *
+ * @param btc bit-timing constants of the controller, see
+ * can_get_bittiming_const or can_get_data_bittiming_const
+ * @param clock clock of the controller, see can_get_clock
+ * @param bitrate wanted bitrate of the can bus
+ * @param sample_point wanted sample point in one-tenth of a percent, or 0 for
+ * the CiA recommended value
+ * @param bt pointer to store the result
+ *
+ * libsocketcan carries a constant table of bit timings for the mcp251x,
+ * flexcan and m_can controllers at 8, 40 and 80 MHz, for the standard
+ * bitrates from 125 kbit/s to 8 Mbit/s and the sample points 75%, 80% and
+ * 87.5%. The table is generated by gen_bittiming_table and every entry
+ * reaches its bitrate exactly. An entry is only used if all constants of
+ * the controller match the ones it was calculated for, so a driver
+ * reporting different limits under the same name misses the table.
+ *
+ * The result has the form of can_calc_bittiming, bt->bitrate is 0.
+ *
+ * @return 0 if the table has an entry, bt is filled then
+ * @return -1 if not, errno is set to ENOENT then
+ */
+int can_lookup_bittiming(const struct can_bittiming_const *btc,
+			 const struct can_clock *clock, __u32 bitrate,
+			 __u32 sample_point, struct can_bittiming *bt)
+{
+	unsigned int i, c;
+
+	if (sample_point == 0)
+		sample_point = default_sample_point(bitrate);
+
+	for (c = 0; c < ARRAY_SIZE(bittiming_table_btc); c++) {
+		const struct can_bittiming_const *tbtc = &bittiming_table_btc[c];
+
+		if (strncmp(tbtc->name, btc->name, sizeof(btc->name)) == 0 &&
+		    tbtc->tseg1_min == btc->tseg1_min &&
+		    tbtc->tseg1_max == btc->tseg1_max &&
+		    tbtc->tseg2_min == btc->tseg2_min &&
+		    tbtc->tseg2_max == btc->tseg2_max &&
+		    tbtc->sjw_max == btc->sjw_max &&
+		    tbtc->brp_min == btc->brp_min &&
+		    tbtc->brp_max == btc->brp_max &&
+		    tbtc->brp_inc == btc->brp_inc)
+			break;
+	}
+
+	if (c < ARRAY_SIZE(bittiming_table_btc)) {
+		for (i = 0; i < ARRAY_SIZE(bittiming_table); i++) {
+			const struct bittiming_table_entry *e = &bittiming_table[i];
+
+			if (e->btc == c && e->freq == clock->freq &&
+			    e->bitrate == bitrate &&
+			    e->sample_point == sample_point) {
+				*bt = e->bt;
+				return 0;
+			}
+		}
+	}
+
+	errno = ENOENT;
+	return -1;
+}
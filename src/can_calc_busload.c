@@ -0,0 +1,200 @@
+/* can_calc_busload.c
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * @file
+ * @brief bus-load estimation from frame and byte counts
+ *
+ * The bit counts follow ISO 11898-1. The stuffed part of a frame runs from
+ * the start of frame to the end of the CRC in classic frames, and to the end
+ * of the data field in CAN FD frames, whose stuff count and CRC carry fixed
+ * stuff bits instead.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "libsocketcan_config.h"
+#endif
+
+#include <string.h>
+#include <errno.h>
+
+#include <libsocketcan.h>
+
+/*
+ * Bits of a classic base frame without data: SOF, identifier, RTR, IDE, r0,
+ * DLC, CRC, CRC delimiter, ACK slot and delimiter, EOF and intermission.
+ * The extended format adds SRR and the identifier extension.
+ */
+#define CLASSIC_BITS		47
+#define CLASSIC_STUFFED		34	/* SOF to the end of the CRC */
+#define EXTENDED_BITS		20
+
+/*
+ * CAN FD frames: SOF up to BRS is sent with the nominal bitrate, so are the
+ * CRC delimiter, ACK slot and delimiter, EOF and intermission. ESI, DLC,
+ * data, stuff count and CRC are sent with the data bitrate if BRS is set.
+ */
+#define FD_ARBITRATION_BITS	17	/* SOF, identifier, RRS, IDE, FDF, res, BRS */
+#define FD_EXTENDED_BITS	19	/* SRR, identifier extension */
+#define FD_TAIL_BITS		13
+#define FD_CONTROL_BITS		5	/* ESI, DLC */
+#define FD_STUFF_COUNT_BITS	4
+
+/*
+ * Random bits contain a run of five equal bits, which needs a stuff bit,
+ * about once per 30 bits: after a change it takes 2 + 4 + 8 + 16 bits on
+ * average until four more bits equal the first one.
+ */
+#define AVG_STUFF_INTERVAL	30.0
+
+struct frame_bits {
+	double nominal;		/* bits sent with the nominal bitrate */
+	double data;		/* bits sent with the data bitrate */
+	double stuffed;		/* bits subject to dynamic stuffing */
+	double stuffed_nominal;	/* share of them sent with the nominal bitrate */
+};
+
+/**
+ * @ingroup intern
+ * @brief frame_bits - get the bits of a frame without dynamic stuff bits
+ *
+ * @param len payload length in bytes
+ * @param flags CAN_BUSLOAD_* flags
+ * @param fb pointer to store the bit counts
+ */
+static void frame_bits(double len, __u32 flags, struct frame_bits *fb)
+{
+	double arbitration;
+
+	if (!(flags & CAN_BUSLOAD_FD)) {
+		fb->nominal = CLASSIC_BITS + 8 * len;
+		fb->stuffed = CLASSIC_STUFFED + 8 * len;
+		if (flags & CAN_BUSLOAD_EXTENDED) {
+			fb->nominal += EXTENDED_BITS;
+			fb->stuffed += EXTENDED_BITS;
+		}
+		fb->data = 0;
+		fb->stuffed_nominal = fb->stuffed;
+		return;
+	}
+
+	arbitration = FD_ARBITRATION_BITS;
+	if (flags & CAN_BUSLOAD_EXTENDED)
+		arbitration += FD_EXTENDED_BITS;
+
+	fb->nominal = arbitration + FD_TAIL_BITS;
+	fb->data = FD_CONTROL_BITS + 8 * len + FD_STUFF_COUNT_BITS;
+
+	/* CRC-17 up to 16 bytes, CRC-21 above, a fixed stuff bit every 4 bits */
+	if (len > 16)
+		fb->data += 21 + 7;
+	else
+		fb->data += 17 + 6;
+
+	fb->stuffed = arbitration + FD_CONTROL_BITS + 8 * len;
+	fb->stuffed_nominal = arbitration;
+}
+
+/**
+ * @ingroup intern
+ * @brief frame_time - get the duration of a frame
+ *
+ * @param fb bit counts of the frame
+ * @param stuff dynamic stuff bits of the frame
+ * @param bitrate nominal bitrate
+ * @param dbitrate data bitrate
+ *
+ * The stuff bits are split between the two phases like the stuffed bits.
+ *
+ * @return duration in seconds
+ */
+static double frame_time(const struct frame_bits *fb, double stuff,
+			 __u32 bitrate, __u32 dbitrate)
+{
+	double nominal_stuff = stuff * fb->stuffed_nominal / fb->stuffed;
+
+	return (fb->nominal + nominal_stuff) / bitrate +
+	       (fb->data + stuff - nominal_stuff) / dbitrate;
+}
+
+/**
+ * @ingroup extern
+ * can_calc_busload - estimate the bus load from frame and byte counts
+ *
+ * @param frames number of frames sent on the bus in the interval
+ * @param bytes number of payload bytes of these frames
+ * @param interval_us length of the interval in microseconds
+ * @param bitrate nominal bitrate of the can bus
+ * @param dbitrate data bitrate of CAN FD frames with bitrate switch, or 0
+ * @param flags CAN_BUSLOAD_* flags describing the frames
+ * @param load pointer to store the estimate
+ *
+ * This converts the frames and bytes into the time they occupy the bus,
+ * including the frame overhead and the intermission, and reports it as a
+ * share of the interval. All frames are assumed to carry the average
+ * payload. Since the stuff bits depend on the content, three estimates are
+ * given: without stuff bits, with the stuff bits of random content and with
+ * the most stuff bits possible.
+ *
+ * Frames are counted as classic frames with 11 bit identifiers unless flags
+ * say otherwise. With CAN_BUSLOAD_FD, the data phase of the frames is sent
+ * with dbitrate if it is not 0, with bitrate otherwise.
+ *
+ * A controller only counts the frames it sends and receives, so the
+ * statistics of one interface cover the bus only if it receives all frames
+ * on it, i.e. without hardware filters.
+ *
+ * @return 0 if success
+ * @return -1 if failed, errno is set to EINVAL for invalid parameters
+ */
+int can_calc_busload(__u64 frames, __u64 bytes, __u64 interval_us,
+		     __u32 bitrate, __u32 dbitrate, __u32 flags,
+		     struct can_busload *load)
+{
+	struct frame_bits fb;
+	double busy;
+
+	if (bitrate == 0 || interval_us == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!(flags & CAN_BUSLOAD_FD) || dbitrate == 0)
+		dbitrate = bitrate;
+
+	memset(load, 0, sizeof(*load));
+	load->interval_us = interval_us;
+	load->frames = frames;
+	load->bytes = bytes;
+
+	if (frames == 0)
+		return 0;
+
+	frame_bits((double)bytes / frames, flags, &fb);
+
+	/* percent of the interval */
+	busy = frames * 100.0 * 1000000 / interval_us;
+
+	load->min = busy * frame_time(&fb, 0, bitrate, dbitrate);
+	load->avg = busy * frame_time(&fb, fb.stuffed / AVG_STUFF_INTERVAL,
+				      bitrate, dbitrate);
+	/* the first stuff bit after 5 bits, every further one after 4 */
+	load->max = busy * frame_time(&fb, (fb.stuffed - 1) / 4,
+				      bitrate, dbitrate);
+
+	return 0;
+}
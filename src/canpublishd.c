@@ -0,0 +1,118 @@
+/* canpublishd.c
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * @file
+ * @brief daemon publishing the snapshots of all can interfaces
+ *
+ * canpublishd keeps the snapshots of all can interfaces in shared memory,
+ * see can_publisher_open, so that any number of processes can read them
+ * with can_reader_open instead of querying the kernel each. It runs in the
+ * foreground until it gets SIGINT or SIGTERM.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "libsocketcan_config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+
+#include <libsocketcan.h>
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+	(void)sig;
+
+	stop = 1;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-n shm_name] [-m max_links] "
+		"[-i interval_ms]\n\n"
+		"  -n  name of the shared memory object (default %s)\n"
+		"  -m  number of interfaces to publish (default 64)\n"
+		"  -i  refresh interval of the counters (default 1000)\n",
+		prog, CAN_PUBLISH_DEFAULT);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *shm_name = CAN_PUBLISH_DEFAULT;
+	int max_links = 64;
+	unsigned long interval_ms = 1000;
+	struct can_publisher *pub;
+	struct sigaction sa = {
+		.sa_handler = on_signal,	/* no SA_RESTART, poll returns */
+	};
+	struct pollfd pfd;
+	int opt, ret = EXIT_SUCCESS;
+
+	while ((opt = getopt(argc, argv, "n:m:i:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			shm_name = optarg;
+			break;
+		case 'm':
+			max_links = atoi(optarg);
+			break;
+		case 'i':
+			interval_ms = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	pub = can_publisher_open(shm_name, max_links, interval_ms);
+	if (pub == NULL) {
+		fprintf(stderr, "Cannot publish to %s\n", shm_name);
+		return EXIT_FAILURE;
+	}
+
+	pfd.fd = can_publisher_fd(pub);
+	pfd.events = POLLIN;
+
+	while (!stop) {
+		if (poll(&pfd, 1, can_publisher_timeout(pub)) < 0 &&
+		    errno != EINTR) {
+			perror("poll");
+			ret = EXIT_FAILURE;
+			break;
+		}
+
+		if (can_publisher_dispatch(pub) < 0) {
+			ret = EXIT_FAILURE;
+			break;
+		}
+	}
+
+	can_publisher_close(pub);
+
+	return ret;
+}
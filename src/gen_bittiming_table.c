@@ -0,0 +1,239 @@
+/* gen_bittiming_table.c
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * @file
+ * @brief generator for can_bittiming_table.h
+ *
+ * Run "make bittiming-table" in src/ to regenerate the table after changing
+ * the controllers, clocks or bitrates below. Every entry is checked against
+ * the constraints of its controller before it is written, the generator
+ * fails if one does not fit.
+ *
+ * Built with CHECK_TABLE defined, as check_bittiming_table for "make check",
+ * it runs the same checks on the shipped table instead.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "libsocketcan_config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libsocketcan.h>
+
+#ifdef CHECK_TABLE
+#include "can_bittiming_table.h"
+#else
+/* bit-timing constants of the controllers, as their drivers report them */
+static const struct controller {
+	struct can_bittiming_const btc;
+	int data;	/* data phase constants of a CAN FD controller */
+} controllers[] = {
+	{ { "mcp251x", 3, 16, 2, 8, 4, 1, 64, 1 }, 0 },
+	{ { "flexcan", 4, 16, 2, 8, 4, 1, 256, 1 }, 0 },
+	/* m_can v3.0.x */
+	{ { "m_can", 2, 64, 1, 16, 16, 1, 1024, 1 }, 0 },
+	{ { "m_can", 1, 16, 1, 8, 4, 1, 32, 1 }, 1 },
+	/* m_can v3.1.x and later */
+	{ { "m_can", 2, 256, 2, 128, 128, 1, 512, 1 }, 0 },
+	{ { "m_can", 1, 32, 1, 16, 16, 1, 32, 1 }, 1 },
+};
+
+static const __u32 clocks[] = {
+	8000000, 40000000, 80000000,
+};
+
+/* nominal bitrates go up to 1 Mbit/s, data bitrates start there */
+static const __u32 bitrates[] = {
+	125000, 250000, 500000, 800000, 1000000,
+	2000000, 4000000, 5000000, 8000000,
+};
+#define DATA_BITRATE_MIN 1000000
+
+static const __u32 sample_points[] = {
+	750, 800, 875,
+};
+#endif
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/**
+ * @ingroup intern
+ * @brief tq_to_brp - prescaler the kernel derives from a time quantum
+ *
+ * Same rounding as can_fixup_bittiming in the kernel.
+ */
+static __u64 tq_to_brp(const struct can_bittiming_const *btc, __u32 freq,
+		       __u32 tq)
+{
+	__u64 brp = (__u64)freq * tq;
+
+	if (btc->brp_inc > 1)
+		brp /= btc->brp_inc;
+	brp = (brp + 500000000 - 1) / 1000000000;
+	if (btc->brp_inc > 1)
+		brp *= btc->brp_inc;
+
+	return brp;
+}
+
+/**
+ * @ingroup intern
+ * @brief check_entry - check a bit timing against the controller constraints
+ *
+ * Besides the limits of the controller, the kernel requires bitrate 0 and
+ * tq set for a fully specified bit timing, and derives the prescaler from
+ * tq, which has to give brp back.
+ *
+ * @return 0 if the kernel accepts the bit timing and it reaches the bitrate
+ * exactly
+ * @return -1 otherwise
+ */
+static int check_entry(const struct can_bittiming_const *btc, __u32 freq,
+		       __u32 bitrate, const struct can_bittiming *bt)
+{
+	__u32 tseg1 = bt->prop_seg + bt->phase_seg1;
+	__u32 tsegall = 1 + tseg1 + bt->phase_seg2;
+
+	if (bt->bitrate != 0 || bt->tq == 0 ||
+	    tq_to_brp(btc, freq, bt->tq) != bt->brp)
+		return -1;
+	if (bt->brp < btc->brp_min || bt->brp > btc->brp_max ||
+	    bt->brp % btc->brp_inc)
+		return -1;
+	if (bt->phase_seg1 > btc->tseg1_max ||
+	    tseg1 < btc->tseg1_min || tseg1 > btc->tseg1_max)
+		return -1;
+	if (bt->phase_seg2 < btc->tseg2_min || bt->phase_seg2 > btc->tseg2_max)
+		return -1;
+	if (bt->sjw < 1 || bt->sjw > btc->sjw_max ||
+	    bt->sjw > bt->phase_seg1 || bt->sjw > bt->phase_seg2)
+		return -1;
+	if ((__u64)bt->brp * tsegall * bitrate != freq)
+		return -1;
+	if (bt->sample_point != 1000 * (tsegall - bt->phase_seg2) / tsegall)
+		return -1;
+
+	return 0;
+}
+
+#ifdef CHECK_TABLE
+int main(void)
+{
+	unsigned int i, failed = 0;
+
+	for (i = 0; i < ARRAY_SIZE(bittiming_table); i++) {
+		const struct bittiming_table_entry *e = &bittiming_table[i];
+
+		if (e->btc >= ARRAY_SIZE(bittiming_table_btc) ||
+		    check_entry(&bittiming_table_btc[e->btc], e->freq,
+				e->bitrate, &e->bt) < 0) {
+			fprintf(stderr, "invalid table entry %u: %u Hz, %u bit/s, "
+				"sample point %u\n", i, e->freq, e->bitrate,
+				e->sample_point);
+			failed++;
+		}
+	}
+
+	printf("%u of %u entries valid\n", i - failed, i);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+#else
+int main(void)
+{
+	unsigned int c, f, b, s, n = 0;
+
+	printf("/* can_bittiming_table.h - generated by gen_bittiming_table, "
+	       "do not edit */\n\n");
+
+	printf("/* precalculated bit timing, bt in the form the kernel accepts */\n");
+	printf("struct bittiming_table_entry {\n");
+	printf("\tunsigned int btc;\t/* index into bittiming_table_btc */\n");
+	printf("\t__u32 freq;\n");
+	printf("\t__u32 bitrate;\n");
+	printf("\t__u32 sample_point;\n");
+	printf("\tstruct can_bittiming bt;\n");
+	printf("};\n\n");
+
+	printf("static const struct can_bittiming_const bittiming_table_btc[] = {\n");
+	for (c = 0; c < ARRAY_SIZE(controllers); c++) {
+		const struct can_bittiming_const *btc = &controllers[c].btc;
+
+		printf("\t{ \"%s\", %u, %u, %u, %u, %u, %u, %u, %u },\n",
+		       btc->name, btc->tseg1_min, btc->tseg1_max,
+		       btc->tseg2_min, btc->tseg2_max, btc->sjw_max,
+		       btc->brp_min, btc->brp_max, btc->brp_inc);
+	}
+	printf("};\n\n");
+
+	printf("static const struct bittiming_table_entry bittiming_table[] = {\n");
+	printf("\t/* btc, clock, bitrate, sample_point, { bitrate, sample_point, "
+	       "tq, prop_seg, phase_seg1, phase_seg2, sjw, brp } */\n");
+	for (c = 0; c < ARRAY_SIZE(controllers); c++) {
+		for (f = 0; f < ARRAY_SIZE(clocks); f++) {
+			struct can_clock clock = { .freq = clocks[f] };
+
+			for (b = 0; b < ARRAY_SIZE(bitrates); b++) {
+				if (controllers[c].data ?
+				    bitrates[b] < DATA_BITRATE_MIN :
+				    bitrates[b] > DATA_BITRATE_MIN)
+					continue;
+
+				for (s = 0; s < ARRAY_SIZE(sample_points); s++) {
+					struct can_bittiming bt;
+					__u64 tsegall;
+
+					if (can_calc_bittiming(&controllers[c].btc, &clock,
+							       bitrates[b], sample_points[s],
+							       0, &bt) < 0)
+						continue;
+
+					/* only exact bitrates go into the table */
+					tsegall = 1 + bt.prop_seg + bt.phase_seg1 +
+						  bt.phase_seg2;
+					if (bt.brp * tsegall * bitrates[b] != clock.freq)
+						continue;
+
+					if (check_entry(&controllers[c].btc, clock.freq,
+							bitrates[b], &bt) < 0) {
+						fprintf(stderr, "invalid bit timing for %s at "
+							"%u Hz, %u bit/s, sample point %u\n",
+							controllers[c].btc.name, clock.freq,
+							bitrates[b], sample_points[s]);
+						return EXIT_FAILURE;
+					}
+
+					printf("\t{ %u, %u, %u, %u, { %u, %u, %u, %u, %u, %u, %u, %u } },\n",
+					       c, clock.freq, bitrates[b], sample_points[s],
+					       bt.bitrate, bt.sample_point, bt.tq,
+					       bt.prop_seg, bt.phase_seg1, bt.phase_seg2,
+					       bt.sjw, bt.brp);
+					n++;
+				}
+			}
+		}
+	}
+	printf("};\n");
+
+	fprintf(stderr, "%u entries\n", n);
+
+	return EXIT_SUCCESS;
+}
+#endif
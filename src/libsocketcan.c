@@ -32,7 +32,21 @@
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <time.h>
 #include <net/if.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* the handle-less API reuses a netlink socket per thread */
+#if defined(HAVE_PTHREAD) && !defined(DISABLE_THREAD_SOCKET)
+#define THREAD_SOCKET
+#endif
 
 #include <linux/if_link.h>
 #include <linux/rtnetlink.h>
@@ -54,9 +68,29 @@
 
 #define IFLA_CAN_MAX	(__IFLA_CAN_MAX - 1)
 
+#ifndef SOL_NETLINK
+#define SOL_NETLINK	270
+#endif
+
+#ifndef RTEXT_FILTER_SKIP_STATS
+#define RTEXT_FILTER_SKIP_STATS	(1 << 3)
+#endif
+
 #define IF_UP 1
 #define IF_DOWN 2
 
+/*
+ * Requests of a batch are sent in chunks, so that the acks of one chunk fit
+ * into the socket receive buffer.
+ */
+#define BATCH_CHUNK 32
+
+/*
+ * Initial size of the receive buffer of a handle. Dumps are sent in chunks
+ * sized after the buffer the reader last used, up to 32 KiB.
+ */
+#define RX_BUF_SIZE 16384
+
 #define GET_STATE 1
 #define GET_RESTART_MS 2
 #define GET_BITTIMING 3
@@ -68,10 +102,15 @@
 #define GET_LINK_STATS 9
 #define GET_DATA_BITTIMING 10
 #define GET_DATA_BITTIMING_CONST 11
+#define GET_LINK_INFO 12
+#define GET_IFINDEX 13
+#define GET_CAPS 14
+#define GET_FLAGS 15
 
 struct get_req {
 	struct nlmsghdr n;
 	struct ifinfomsg i;
+	char buf[64];
 };
 
 struct set_req {
@@ -89,6 +128,198 @@ struct req_info {
 	struct can_bittiming *dbittiming;
 };
 
+struct link_name {
+	int ifindex;
+	char name[IFNAMSIZ];
+};
+
+struct thread_handle {
+	struct can_handle *h;
+	unsigned int fork_gen;	/* fork_gen at the time h was opened */
+	int busy;		/* h is in use further up the call stack */
+};
+
+struct link_caps {
+	char name[IFNAMSIZ];
+	struct can_caps caps;
+};
+
+struct rx_buf {
+	char *buf;
+	size_t size;
+	int user;		/* provided by the caller, never resized or freed */
+};
+
+struct snapshot {
+	char name[IFNAMSIZ];	/* as requested, empty if requested by index */
+	int ifindex;		/* as requested, 0 if requested by name */
+	struct can_link_info info;
+	__u64 done_us;		/* completion time of the last query */
+	int valid;		/* info holds the result of the last query */
+	int err;		/* errno of the last query, 0 if it succeeded */
+	int in_flight;		/* a query is running */
+	unsigned int gen;	/* number of completed queries */
+	struct snapshot *next;
+};
+
+struct async_req {
+	__u32 seq;
+	int get;		/* waiting for RTM_NEWLINK instead of an ack */
+	can_async_cb cb;
+	void *data;
+	struct async_req *next;
+};
+
+struct can_handle {
+	int fd;
+	__u32 seq;		/* sequence number of the last request */
+	struct async_req *pending;
+	int link_subscribers;	/* users of the RTNLGRP_LINK membership */
+	int no_getstats;	/* kernel does not know RTM_GETSTATS */
+	int name_cache;		/* name cache enabled */
+	int names_stale;	/* notifications were lost, resync the cache */
+	struct link_name *names;
+	int nnames;
+	int names_alloc;
+	int caps_cache;		/* capability cache enabled */
+	struct link_caps *caps;
+	int ncaps;
+	int caps_alloc;
+	struct rx_buf rx;
+	int rx_busy;		/* rx is used by a receive loop */
+	char err_msg[256];	/* extended ack of the last rejected request */
+	int coalesce;		/* query coalescing enabled */
+	__u32 coalesce_window_us;
+	unsigned int mod_gen;	/* bumped by every modification request */
+	struct snapshot *snapshots;
+	struct can_coalesce_stats coalesce_stats;
+#ifdef HAVE_PTHREAD
+	pthread_mutex_t coalesce_lock;	/* snapshots and counters */
+	pthread_cond_t coalesce_cond;	/* signalled when a query completes */
+	pthread_mutex_t io_lock;	/* socket use of coalesced queries */
+#endif
+};
+
+struct batch_entry {
+	struct set_req req;
+	int err;
+};
+
+struct can_batch {
+	struct batch_entry *entries;
+	int n;
+	int alloc;
+};
+
+struct can_prepared {
+	struct can_handle *h;
+	struct nlmsghdr n[];	/* the encoded request */
+};
+
+struct monitor_link {
+	struct can_link_info info;
+	int seen;
+};
+
+struct can_monitor {
+	int fd;
+	struct can_handle *h;	/* for resynchronisation dumps */
+	can_monitor_cb cb;
+	void *data;
+	struct monitor_link *links;
+	int nlinks;
+	int alloc;
+	struct rx_buf rx;
+};
+
+struct supervised_link {
+	struct can_recovery rec;
+	struct set_req restart;	/* prebuilt IFLA_CAN_RESTART request */
+	int auto_restart;	/* restart_ms is set, the kernel restarts */
+	int streak;		/* restarts since the delay was reset */
+	__u64 bus_off_us;	/* start of the current bus-off, 0 if none */
+	__u64 due_us;		/* time of the pending restart, 0 if none */
+	__u64 recovered_us;	/* end of the last bus-off */
+	__u64 window_us;	/* start of the budget window */
+	__u32 window_restarts;	/* restarts in the budget window */
+};
+
+struct sampled_link {
+	int ifindex;
+	char name[IFNAMSIZ];
+	int seen;		/* reported by the last dump */
+	int have_prev;		/* prev holds the counters of the last dump */
+	struct can_link_info prev;
+	__u64 prev_us;		/* time of the last dump */
+	struct can_sample *ring;
+	int head;		/* next slot to write */
+	int count;		/* valid samples in the ring */
+};
+
+struct can_sampler {
+	struct can_handle *h;
+	__u64 interval_us;
+	__u64 due_us;		/* time of the next sample */
+	__u64 now_us;		/* time of the sample being taken */
+	int depth;		/* samples kept per link */
+	struct sampled_link *links;
+	int nlinks;
+	int alloc;
+};
+
+#define SHM_MAGIC	0x43414e53	/* "CANS" */
+#define SHM_VERSION	1
+
+/* give up on a slot which stays odd, its publisher died while writing it */
+#define SHM_READ_RETRIES	10000
+
+struct shm_slot {
+	__u32 seq;		/* odd while the publisher writes the slot */
+	__u32 reserved;
+	struct can_link_info info;	/* ifindex is 0 if the slot is free */
+};
+
+/* layout of the shared memory object, magic is written last */
+struct shm_region {
+	__u32 magic;
+	__u32 version;
+	__u32 slot_size;	/* sizeof(struct shm_slot) of the publisher */
+	__u32 max_links;
+	__u64 update_us;	/* CLOCK_MONOTONIC time of the last update */
+	struct shm_slot slots[];
+};
+
+struct can_publisher {
+	struct can_monitor *mon;
+	struct can_handle *h;	/* for the periodic refresh */
+	char *shm_name;
+	int shm_fd;		/* locked as long as the publisher runs */
+	struct shm_region *shm;
+	size_t size;
+	int *slot_ifindex;	/* private copy of the slot owners */
+	int *slot_seen;		/* reported by the last refresh */
+	int max_links;
+	__u64 interval_us;
+	__u64 due_us;		/* time of the next refresh */
+};
+
+struct can_reader {
+	const struct shm_region *shm;
+	size_t size;
+	int max_links;
+};
+
+struct can_supervisor {
+	struct can_monitor *mon;
+	struct can_handle *h;	/* for the restart requests */
+	struct can_supervisor_opts opts;
+	can_supervisor_cb cb;
+	void *data;
+	struct supervised_link *links;
+	int nlinks;
+	int alloc;
+};
+
 /**
  * @brief this method parse attributions of link info
  *
@@ -153,24 +384,197 @@ static int addattr_l(struct nlmsghdr *n, size_t maxlen, int type,
 	return 0;
 }
 
+static int async_process_msg(struct can_handle *h, struct nlmsghdr *nl_msg);
+static void coalesce_invalidate(struct can_handle *h);
+
+static __u64 monotonic_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (__u64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 /**
  * @ingroup intern
- * @brief send_mod_request - send a linkinfo modification request
+ * @brief rx_begin - get the receive buffer for a receive loop
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param tmp storage for a temporary buffer
+ *
+ * Receive loops nest if a callback invoked from one calls the library on the
+ * same handle again. Only the outermost loop uses the buffer of the handle,
+ * nested ones get a temporary buffer, which rx_end frees again.
+ *
+ * @return buffer to pass to rx_recv and rx_end
+ */
+static struct rx_buf *rx_begin(struct can_handle *h, struct rx_buf *tmp)
+{
+	if (h->rx_busy) {
+		memset(tmp, 0, sizeof(*tmp));
+		return tmp;
+	}
+
+	h->rx_busy = 1;
+
+	return &h->rx;
+}
+
+static void rx_end(struct can_handle *h, struct rx_buf *rx)
+{
+	if (rx == &h->rx)
+		h->rx_busy = 0;
+	else
+		free(rx->buf);
+}
+
+/**
+ * @ingroup intern
+ * @brief rx_overrun - note that the socket of a handle overran
+ *
+ * @param h handle to a priorly opened netlink socket
+ *
+ * A receive failed with ENOBUFS, so link notifications for the name and caps
+ * caches may have been dropped. The name cache is resynced by its next
+ * lookup, the caps cache is emptied and refilled on demand. The replies to
+ * requests are still queued, every receive loop keeps reading after this.
+ */
+static void rx_overrun(struct can_handle *h)
+{
+	h->names_stale = 1;
+	h->ncaps = 0;
+}
+
+static ssize_t rx_recv(int fd, struct rx_buf *rx, int flags);
+
+/**
+ * @ingroup intern
+ * @brief rx_recv_reply - receive one netlink datagram while waiting for a reply
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param rx receive buffer
+ * @param lost flag of the receive loop, set once the socket overran
+ *
+ * rtnetlink queues the reply to a request before sendmsg returns, or drops
+ * it if the socket is full. So after an overrun the reply is either queued
+ * already or lost: the loop keeps reading what is queued, without blocking,
+ * and fails once nothing is left. Dumps are never dropped, their next part
+ * is queued whenever one is read.
+ *
+ * @return length of the datagram in rx->buf if success
+ * @return -1 if failed, errno is set to ENOBUFS if the reply was lost
+ */
+static ssize_t rx_recv_reply(struct can_handle *h, struct rx_buf *rx,
+			     int *lost)
+{
+	ssize_t len;
+
+	while (1) {
+		len = rx_recv(h->fd, rx, *lost ? MSG_DONTWAIT : 0);
+		if (len >= 0)
+			return len;
+		if (errno == EINTR)
+			continue;
+		if (errno == ENOBUFS) {
+			rx_overrun(h);
+			*lost = 1;
+			continue;
+		}
+		if (*lost && (errno == EAGAIN || errno == EWOULDBLOCK))
+			errno = ENOBUFS;
+		return -1;
+	}
+}
+
+/**
+ * @ingroup intern
+ * @brief rx_recv - receive one netlink datagram
+ *
+ * @param fd netlink socket
+ * @param rx receive buffer
+ * @param flags flags for recv, e.g. MSG_DONTWAIT
+ *
+ * The length of the next datagram is peeked at with MSG_PEEK | MSG_TRUNC
+ * first. If it does not fit, the buffer is enlarged, so that a large dump is
+ * never truncated. A buffer provided by the caller is not enlarged, the
+ * datagram is discarded instead.
+ *
+ * @return length of the datagram in rx->buf if success
+ * @return -1 if failed, errno is set to EMSGSIZE if the datagram did not fit
+ */
+static ssize_t rx_recv(int fd, struct rx_buf *rx, int flags)
+{
+	ssize_t len;
+	size_t size;
+
+	len = recv(fd, NULL, 0, MSG_PEEK | MSG_TRUNC | flags);
+	if (len < 0)
+		return -1;
+
+	if ((size_t) len > rx->size) {
+		if (rx->user) {
+			recv(fd, NULL, 0, flags);
+			fprintf(stderr, "Receive buffer too small for %zd byte "
+				"message\n", len);
+			errno = EMSGSIZE;
+			return -1;
+		}
+
+		size = rx->size ? rx->size : RX_BUF_SIZE;
+		while (size < (size_t) len)
+			size *= 2;
+
+		free(rx->buf);
+		rx->size = 0;
+		rx->buf = malloc(size);
+		if (rx->buf == NULL) {
+			perror("Cannot allocate receive buffer");
+			return -1;
+		}
+		rx->size = size;
+	}
+
+	return recv(fd, rx->buf, rx->size, flags);
+}
+
+/**
+ * @ingroup intern
+ * @brief next_seq - get a new sequence number for a request
+ *
+ * @param h handle to a priorly opened netlink socket
+ *
+ * Sequence number 0 is left to kernel notifications and the numbers stay in
+ * the positive int range, so that they can be returned by the async API.
+ *
+ * @return sequence number
+ */
+static __u32 next_seq(struct can_handle *h)
+{
+	h->seq = (h->seq + 1) & 0x7fffffff;
+	if (h->seq == 0)
+		h->seq = 1;
+
+	return h->seq;
+}
+
+/**
+ * @ingroup intern
+ * @brief send_request - send a request without waiting for the reply
  *
- * @param fd decriptor to a priorly opened netlink socket
+ * @param h handle to a priorly opened netlink socket
  * @param n netlink message containing the request
  *
- * sends a request to setup the the linkinfo to netlink layer and awaits the
- * status.
+ * Assigns a new sequence number to the request and sends it to the netlink
+ * layer.
  *
  * @return 0 if success
  * @return negativ if failed
  */
-static int send_mod_request(int fd, struct nlmsghdr *n)
+static int send_request(struct can_handle *h, struct nlmsghdr *n)
 {
 	int status;
 	struct sockaddr_nl nladdr;
-	struct nlmsghdr *h;
 
 	struct iovec iov = {
 		.iov_base = (void *)n,
@@ -182,7 +586,6 @@ static int send_mod_request(int fd, struct nlmsghdr *n)
 		.msg_iov = &iov,
 		.msg_iovlen = 1,
 	};
-	char buf[16384];
 
 	memset(&nladdr, 0, sizeof(nladdr));
 
@@ -190,96 +593,288 @@ static int send_mod_request(int fd, struct nlmsghdr *n)
 	nladdr.nl_pid = 0;
 	nladdr.nl_groups = 0;
 
-	n->nlmsg_seq = 0;
-	n->nlmsg_flags |= NLM_F_ACK;
+	n->nlmsg_seq = next_seq(h);
 
-	status = sendmsg(fd, &msg, 0);
+	status = sendmsg(h->fd, &msg, 0);
 
 	if (status < 0) {
 		perror("Cannot talk to rtnetlink");
 		return -1;
 	}
 
-	iov.iov_base = buf;
-	while (1) {
-		iov.iov_len = sizeof(buf);
-		status = recvmsg(fd, &msg, 0);
-		for (h = (struct nlmsghdr *)buf; (size_t) status >= sizeof(*h);) {
-			int len = h->nlmsg_len;
-			int l = len - sizeof(*h);
+	/* the kernel has processed the request when sendmsg returns */
+	if (n->nlmsg_type == RTM_NEWLINK)
+		coalesce_invalidate(h);
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief ack_error - decode the status of a request
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param nh NLMSG_ERROR message
+ *
+ * If the request failed, the message of the extended ack is kept in the
+ * handle, see can_handle_get_error_msg. It is cleared if the kernel did not
+ * send one.
+ *
+ * @return 0 if the request succeeded
+ * @return negative errno value if it failed
+ */
+static int ack_error(struct can_handle *h, const struct nlmsghdr *nh)
+{
+	const struct nlmsgerr *err = NLMSG_DATA(nh);
+#ifdef NLM_F_ACK_TLVS
+	struct rtattr *tb[NLMSGERR_ATTR_MAX + 1];
+	size_t off;
+	int len;
+#endif
+
+	if (nh->nlmsg_len < NLMSG_LENGTH(sizeof(*err))) {
+		fprintf(stderr, "ERROR truncated\n");
+		return -EBADMSG;
+	}
+	if (err->error == 0)
+		return 0;
+
+	h->err_msg[0] = '\0';
+
+#ifdef NLM_F_ACK_TLVS
+	if (!(nh->nlmsg_flags & NLM_F_ACK_TLVS))
+		return err->error;
+
+	/* the attributes follow the request, unless it was capped */
+	off = sizeof(*err);
+	if (!(nh->nlmsg_flags & NLM_F_CAPPED))
+		off += err->msg.nlmsg_len - NLMSG_HDRLEN;
+	off = NLMSG_ALIGN(off);
+
+	len = nh->nlmsg_len - NLMSG_LENGTH(off);
+	if (len <= 0)
+		return err->error;
+
+	parse_rtattr(tb, NLMSGERR_ATTR_MAX,
+		     (struct rtattr *)((char *)NLMSG_DATA(nh) + off), len);
+	if (tb[NLMSGERR_ATTR_MSG]) {
+		len = RTA_PAYLOAD(tb[NLMSGERR_ATTR_MSG]);
+		if (len >= (int)sizeof(h->err_msg))
+			len = sizeof(h->err_msg) - 1;
+		memcpy(h->err_msg, RTA_DATA(tb[NLMSGERR_ATTR_MSG]), len);
+		h->err_msg[len] = '\0';
+	}
+#endif
+
+	return err->error;
+}
+
+/**
+ * @ingroup intern
+ * @brief nl_perror - report a request rejected by the kernel
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param err negative errno value as returned by ack_error
+ */
+static void nl_perror(struct can_handle *h, int err)
+{
+	errno = -err;
+	perror("RTNETLINK answers");
+	if (h->err_msg[0] != '\0')
+		fprintf(stderr, "Error: %s\n", h->err_msg);
+	errno = -err;
+}
+
+/**
+ * @ingroup intern
+ * @brief wait_acks - wait for the status of modification requests
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param seqs sequence numbers of the requests
+ * @param errs array to store the status of each request, 0 or a negative
+ * errno value
+ * @param n number of requests
+ *
+ * Replies to other outstanding requests of the async API received meanwhile
+ * are completed on the way.
+ *
+ * @return 0 if the status of all requests was received
+ * @return negativ if failed
+ */
+static int wait_acks(struct can_handle *h, const __u32 *seqs, int *errs, int n)
+{
+	int status;
+	struct nlmsghdr *nh;
+	struct rx_buf tmp, *rx;
+	int remaining = n;
+	int lost = 0;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < n; i++)
+		errs[i] = 1;	/* not acked yet */
+
+	rx = rx_begin(h, &tmp);
+	while (remaining) {
+		status = rx_recv_reply(h, rx, &lost);
+		if (status < 0) {
+			if (errno == EAGAIN)
+				continue;
+			perror("Cannot receive netlink reply");
+			ret = -1;
+			break;
+		}
+		if (status == 0) {
+			fprintf(stderr, "EOF on netlink\n");
+			ret = -1;
+			break;
+		}
+
+		for (nh = (struct nlmsghdr *)rx->buf;
+		     (size_t) status >= sizeof(*nh);) {
+			int len = nh->nlmsg_len;
+			int l = len - sizeof(*nh);
 			if (l < 0 || len > status) {
-				if (msg.msg_flags & MSG_TRUNC) {
-					fprintf(stderr, "Truncated message\n");
-					return -1;
-				}
 				fprintf(stderr,
 					"!!!malformed message: len=%d\n", len);
-				return -1;
+				ret = -1;
+				goto out;
 			}
 
-			if (h->nlmsg_type == NLMSG_ERROR) {
-				struct nlmsgerr *err =
-				    (struct nlmsgerr *)NLMSG_DATA(h);
-				if ((size_t) l < sizeof(struct nlmsgerr)) {
-					fprintf(stderr, "ERROR truncated\n");
-				} else {
-					errno = -err->error;
-					if (errno == 0)
-						return 0;
-
-					perror("RTNETLINK answers");
-				}
-				return -1;
+			for (i = 0; i < n; i++)
+				if (errs[i] == 1 && seqs[i] == nh->nlmsg_seq)
+					break;
+
+			if (i == n) {
+				async_process_msg(h, nh);
+			} else if (nh->nlmsg_type == NLMSG_ERROR) {
+				errs[i] = ack_error(h, nh);
+				remaining--;
 			}
 			status -= NLMSG_ALIGN(len);
-			h = (struct nlmsghdr *)((char *)h + NLMSG_ALIGN(len));
+			nh = (struct nlmsghdr *)((char *)nh + NLMSG_ALIGN(len));
 		}
 	}
 
-	return 0;
+out:
+	rx_end(h, rx);
+
+	return ret;
+}
+
+/**
+ * @ingroup intern
+ * @brief wait_ack - wait for the status of a modification request
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param seq sequence number of the request
+ *
+ * @return 0 if success
+ * @return negativ if failed
+ */
+static int wait_ack(struct can_handle *h, __u32 seq)
+{
+	int err;
+
+	if (wait_acks(h, &seq, &err, 1) < 0)
+		return -1;
+
+	if (err == 0)
+		return 0;
+
+	nl_perror(h, err);
+
+	return -1;
+}
+
+/**
+ * @ingroup intern
+ * @brief send_mod_request - send a linkinfo modification request
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param n netlink message containing the request
+ *
+ * sends a request to setup the the linkinfo to netlink layer and awaits the
+ * status.
+ *
+ * @return 0 if success
+ * @return negativ if failed
+ */
+static int send_mod_request(struct can_handle *h, struct nlmsghdr *n)
+{
+	n->nlmsg_flags |= NLM_F_ACK;
+
+	if (send_request(h, n) < 0)
+		return -1;
+
+	return wait_ack(h, n->nlmsg_seq);
 }
 
 /**
  * @ingroup intern
  * @brief send_dump_request - send a dump linkinfo request
  *
- * @param fd decriptor to a priorly opened netlink socket
+ * @param h handle to a priorly opened netlink socket
  * @param name network interface name, null means all interfaces
+ * @param ifindex interface index, used if name is null, 0 means all interfaces
  * @param family rt_gen message family
  * @param type netlink message header type
+ * @param seq sequence number of the request
+ * @param ext_mask RTEXT_FILTER_* flags sent as IFLA_EXT_MASK, or 0
+ *
+ * A single interface is requested by IFLA_IFNAME or by its index. The
+ * kernel resolves the name itself and answers with exactly one RTM_NEWLINK
+ * message, or with ENODEV.
+ *
+ * A dump of all interfaces carries an IFLA_LINKINFO/IFLA_INFO_KIND "can"
+ * filter, so that the kernel only sends can links. Kernels without kind
+ * filtering, or without the can module loaded, ignore it and send all
+ * links, which are then filtered by the caller.
  *
  * @return 0 if success
  * @return negativ if failed
  */
-static int send_dump_request(int fd, const char *name, int family, int type)
+static int send_dump_request(struct can_handle *h, const char *name,
+			     int ifindex, int family, int type, __u32 seq,
+			     __u32 ext_mask)
 {
 	struct get_req req;
 
 	memset(&req, 0, sizeof(req));
 
-	req.n.nlmsg_len = sizeof(req);
+	req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
 	req.n.nlmsg_type = type;
 	req.n.nlmsg_flags = NLM_F_REQUEST;
 	req.n.nlmsg_pid = 0;
-	req.n.nlmsg_seq = 0;
+	req.n.nlmsg_seq = seq;
 
 	req.i.ifi_family = family;
 	/*
-	 * If name is null, set flag to dump link information from all
-	 * interfaces otherwise, just dump specified interface's link
-	 * information.
+	 * If neither name nor index is given, set flag to dump link
+	 * information from all interfaces otherwise, just dump specified
+	 * interface's link information.
 	 */
-	if (name == NULL) {
+	if (name == NULL && ifindex > 0) {
+		req.i.ifi_index = ifindex;
+	} else if (name == NULL) {
+		struct rtattr *linkinfo = NLMSG_TAIL(&req.n);
+		const char *kind = "can";
+
 		req.n.nlmsg_flags |= NLM_F_DUMP;
-	} else {
-		req.i.ifi_index = if_nametoindex(name);
-		if (req.i.ifi_index == 0) {
-			fprintf(stderr, "Cannot find device \"%s\"\n", name);
-			return -1;
-		}
+
+		addattr_l(&req.n, sizeof(req), IFLA_LINKINFO, NULL, 0);
+		addattr_l(&req.n, sizeof(req), IFLA_INFO_KIND, kind,
+			  strlen(kind));
+		linkinfo->rta_len = (void *)NLMSG_TAIL(&req.n) - (void *)linkinfo;
+	} else if (addattr_l(&req.n, sizeof(req), IFLA_IFNAME, name,
+			     strlen(name) + 1) < 0) {
+		return -1;
 	}
 
-	return send(fd, (void *)&req, sizeof(req), 0);
+	if (ext_mask)
+		addattr32(&req.n, sizeof(req), IFLA_EXT_MASK, ext_mask);
+
+	return send(h->fd, (void *)&req, req.n.nlmsg_len, 0);
 }
 
 /**
@@ -296,6 +891,10 @@ static int open_nl_sock()
 	int fd;
 	int sndbuf = 32768;
 	int rcvbuf = 32768;
+#if defined(NETLINK_GET_STRICT_CHK) || defined(NETLINK_CAP_ACK) || \
+    defined(NETLINK_EXT_ACK)
+	int one = 1;
+#endif
 	unsigned int addr_len;
 	struct sockaddr_nl local;
 
@@ -309,680 +908,6581 @@ static int open_nl_sock()
 
 	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (void *)&rcvbuf, sizeof(rcvbuf));
 
+#ifdef NETLINK_GET_STRICT_CHK
+	/*
+	 * Have the kernel check requests strictly, so that malformed ones are
+	 * rejected instead of guessed at and the dump filters are applied
+	 * exactly as sent. Kernels before 4.20 lack the option, which is fine.
+	 */
+	setsockopt(fd, SOL_NETLINK, NETLINK_GET_STRICT_CHK, (void *)&one,
+		   sizeof(one));
+#endif
+
+#ifdef NETLINK_CAP_ACK
+	/* acks carry the header of the request only, not all of it */
+	setsockopt(fd, SOL_NETLINK, NETLINK_CAP_ACK, (void *)&one,
+		   sizeof(one));
+#endif
+
+#ifdef NETLINK_EXT_ACK
+	/* have the kernel explain why it rejected a request */
+	setsockopt(fd, SOL_NETLINK, NETLINK_EXT_ACK, (void *)&one,
+		   sizeof(one));
+#endif
+
 	memset(&local, 0, sizeof(local));
 	local.nl_family = AF_NETLINK;
 	local.nl_groups = 0;
 
 	if (bind(fd, (struct sockaddr *)&local, sizeof(local)) < 0) {
 		perror("Cannot bind netlink socket");
-		return -1;
+		goto err_close;
 	}
 
 	addr_len = sizeof(local);
 	if (getsockname(fd, (struct sockaddr *)&local, &addr_len) < 0) {
 		perror("Cannot getsockname");
-		return -1;
+		goto err_close;
 	}
 	if (addr_len != sizeof(local)) {
 		fprintf(stderr, "Wrong address length %u\n", addr_len);
-		return -1;
+		goto err_close;
 	}
 	if (local.nl_family != AF_NETLINK) {
 		fprintf(stderr, "Wrong address family %d\n", local.nl_family);
-		return -1;
+		goto err_close;
 	}
 	return fd;
+
+err_close:
+	close(fd);
+	return -1;
 }
 
 /**
- * @ingroup intern
- * @brief do_get_nl_link - get linkinfo
+ * @ingroup extern
+ * can_handle_open - open a netlink handle
  *
- * @param fd socket file descriptor to a priorly opened netlink socket
- * @param acquire  which parameter we want to get
- * @param name name of the can device. This is the netdev name, as ifconfig -a
- * shows in your system. usually it contains prefix "can" and the numer of the
- * can line. e.g. "can0"
- * @param res pointer to store the result
+ * This opens and binds a netlink socket once and wraps it into an opaque
+ * handle. The handle can be passed to any number of can_handle_get_* and
+ * can_handle_set_* calls, which saves the socket setup and teardown the name
+ * only API performs on every single call. Close it with can_handle_close.
  *
- * This callback send a dump request into the netlink layer, collect the packet
- * containing the linkinfo and fill the pointer res points to depending on the
- * acquire mode set in param acquire.
+ * A handle must not be used by more than one thread at a time.
  *
- * @return 0 if success
- * @return -1 if failed
+ * @return pointer to the handle if success
+ * @return NULL if failed
  */
-
-static int do_get_nl_link(int fd, __u8 acquire, const char *name, void *res)
+struct can_handle *can_handle_open(void)
 {
-	struct sockaddr_nl peer;
+	struct can_handle *h;
 
-	char cbuf[64];
-	char nlbuf[1024 * 8];
+	h = calloc(1, sizeof(*h));
+	if (h == NULL) {
+		perror("Cannot allocate netlink handle");
+		return NULL;
+	}
 
-	int ret = -1;
-	int done = 0;
+	h->fd = open_nl_sock();
+	if (h->fd < 0) {
+		free(h);
+		return NULL;
+	}
 
-	struct iovec iov = {
-		.iov_base = (void *)nlbuf,
-		.iov_len = sizeof(nlbuf),
-	};
+	return h;
+}
 
-	struct msghdr msg = {
-		.msg_name = (void *)&peer,
-		.msg_namelen = sizeof(peer),
-		.msg_iov = &iov,
-		.msg_iovlen = 1,
-		.msg_control = &cbuf,
-		.msg_controllen = sizeof(cbuf),
-		.msg_flags = 0,
-	};
-	struct nlmsghdr *nl_msg;
-	ssize_t msglen;
+/**
+ * @ingroup extern
+ * can_handle_close - close a netlink handle
+ *
+ * @param h handle as returned by can_handle_open, may be NULL
+ *
+ * This closes the netlink socket and frees the handle. Outstanding requests of
+ * the async API are completed with -ECANCELED.
+ */
+void can_handle_close(struct can_handle *h)
+{
+	struct async_req *req;
 
-	struct rtattr *linkinfo[IFLA_INFO_MAX + 1];
-	struct rtattr *can_attr[IFLA_CAN_MAX + 1];
+	if (h == NULL)
+		return;
 
-	if (send_dump_request(fd, name, AF_PACKET, RTM_GETLINK) < 0) {
-		perror("Cannot send dump request");
-		return ret;
+	while ((req = h->pending) != NULL) {
+		h->pending = req->next;
+		req->cb(h, req->seq, -ECANCELED, NULL, req->data);
+		free(req);
+	}
+
+	close(h->fd);
+	free(h->names);
+	free(h->caps);
+	if (!h->rx.user)
+		free(h->rx.buf);
+	can_handle_coalesce(h, 0, 0);
+	free(h);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_rxbuf - set up the receive buffer of a handle
+ *
+ * @param h netlink handle as returned by can_handle_open
+ * @param buf caller provided buffer, or NULL to let the handle allocate one
+ * @param size size of the buffer in bytes, at least 8192
+ *
+ * Every reply received on a handle goes through one receive buffer, which
+ * keeps the stack usage of the library small. By default the handle
+ * allocates 16 KiB with the first reply and enlarges the buffer when a
+ * larger reply arrives.
+ *
+ * If buf is NULL, the handle allocates size bytes right away and touches
+ * them, so that no allocation or page fault happens in the following calls
+ * unless a reply exceeds size. If buf is given, the handle uses it as is and
+ * never enlarges or frees it, it must stay valid until the handle is closed
+ * or given another buffer. A reply which does not fit is then discarded and
+ * the call receiving it fails with EMSGSIZE. Note that the kernel sends dumps
+ * in chunks of up to 32 KiB if the buffer is that large.
+ *
+ * The buffer must not be changed from a callback invoked by the library.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_rxbuf(struct can_handle *h, void *buf, size_t size)
+{
+	char *mem = buf;
+
+	if (h->rx_busy) {
+		fprintf(stderr, "Receive buffer in use\n");
+		errno = EBUSY;
+		return -1;
+	}
+	if (size < 8192) {
+		fprintf(stderr, "Receive buffer too small\n");
+		errno = EINVAL;
+		return -1;
 	}
 
-	while (!done && (msglen = recvmsg(fd, &msg, 0)) > 0) {
-		size_t u_msglen = (size_t) msglen;
-		/* Check to see if the buffers in msg get truncated */
-		if (msg.msg_namelen != sizeof(peer) ||
-		    (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
-			fprintf(stderr, "Uhoh... truncated message.\n");
+	if (mem == NULL) {
+		mem = malloc(size);
+		if (mem == NULL) {
+			perror("Cannot allocate receive buffer");
 			return -1;
 		}
+		memset(mem, 0, size);
+	}
 
-		for (nl_msg = (struct nlmsghdr *)nlbuf;
-		     NLMSG_OK(nl_msg, u_msglen);
-		     nl_msg = NLMSG_NEXT(nl_msg, u_msglen)) {
-			int type = nl_msg->nlmsg_type;
-			int len;
+	if (!h->rx.user)
+		free(h->rx.buf);
+	h->rx.buf = mem;
+	h->rx.size = size;
+	h->rx.user = buf != NULL;
 
-			if (type == NLMSG_DONE) {
-				done++;
-				continue;
-			}
-			if (type != RTM_NEWLINK)
-				continue;
+	return 0;
+}
 
-			struct ifinfomsg *ifi = NLMSG_DATA(nl_msg);
-			struct rtattr *tb[IFLA_MAX + 1];
+/**
+ * @ingroup extern
+ * can_handle_get_error_msg - get the reason of the last rejected request
+ *
+ * @param h netlink handle as returned by can_handle_open
+ *
+ * When the kernel rejects a request, it may explain why in an extended ack,
+ * e.g. "Bitrate error: ..." when setting an unsupported bit-timing. The
+ * message stays available until the next request on the handle is rejected.
+ *
+ * @return the message of the kernel, or an empty string if it sent none
+ */
+const char *can_handle_get_error_msg(struct can_handle *h)
+{
+	return h->err_msg;
+}
 
-			len =
-				nl_msg->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifinfomsg));
-			parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), len);
+/**
+ * @ingroup intern
+ * @brief handle_subscribe - join or leave the RTNLGRP_LINK multicast group
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param on 1 to join, 0 to leave
+ *
+ * The membership is reference counted, the group is only left when the last
+ * user is gone. Link notifications arrive with sequence number 0 and are
+ * ignored by the request/reply paths.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int handle_subscribe(struct can_handle *h, int on)
+{
+	int group = RTNLGRP_LINK;
+
+	if (on && h->link_subscribers++ > 0)
+		return 0;
+	if (!on && --h->link_subscribers > 0)
+		return 0;
+
+	if (setsockopt(h->fd, SOL_NETLINK, on ? NETLINK_ADD_MEMBERSHIP :
+		       NETLINK_DROP_MEMBERSHIP, &group, sizeof(group)) < 0) {
+		perror("Cannot change RTNLGRP_LINK membership");
+		if (on)
+			h->link_subscribers--;
+		return -1;
+	}
 
-			/* Finish process if the reply message is matched */
-			if (strcmp((char *)RTA_DATA(tb[IFLA_IFNAME]), name) == 0)
-				done++;
-			else
-				continue;
+	return 0;
+}
 
-			if (acquire == GET_LINK_STATS) {
-				if (!tb[IFLA_STATS64]) {
-					fprintf(stderr, "no link statistics (64-bit) found\n");
-				} else {
-					memcpy(res, RTA_DATA(tb[IFLA_STATS64]), sizeof(struct rtnl_link_stats64));
-					ret = 0;
-				}
-				continue;
-			}
+#ifdef THREAD_SOCKET
+static pthread_once_t thread_handle_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_handle_key;
+static int thread_handle_enabled;
+static volatile unsigned int fork_gen;
 
-			if (tb[IFLA_LINKINFO])
-				parse_rtattr_nested(linkinfo,
-						    IFLA_INFO_MAX, tb[IFLA_LINKINFO]);
-			else
-				continue;
+static void thread_handle_free(void *p)
+{
+	struct thread_handle *t = p;
 
-			if (acquire == GET_XSTATS) {
-				if (!linkinfo[IFLA_INFO_XSTATS]) {
-					fprintf(stderr, "no can statistics found\n");
-				} else {
-					memcpy(res, RTA_DATA(linkinfo[IFLA_INFO_XSTATS]),
-					       sizeof(struct can_device_stats));
-					ret = 0;
-				}
-				continue;
-			}
+	can_handle_close(t->h);
+	free(t);
+}
 
-			if (!linkinfo[IFLA_INFO_DATA]) {
-				fprintf(stderr, "no link data found\n");
-				return ret;
-			}
+static void thread_handle_atfork(void)
+{
+	fork_gen++;
+}
 
-			parse_rtattr_nested(can_attr, IFLA_CAN_MAX,
-					    linkinfo[IFLA_INFO_DATA]);
-
-			switch (acquire) {
-			case GET_STATE:
-				if (can_attr[IFLA_CAN_STATE]) {
-					*((int *)res) = *((__u32 *)
-							  RTA_DATA(can_attr
-								   [IFLA_CAN_STATE]));
-					ret = 0;
-				} else {
-					fprintf(stderr, "no state data found\n");
-				}
+/**
+ * @ingroup intern
+ * @brief thread_handle_init - set up the per-thread handles once per process
+ *
+ * Setting LIBSOCKETCAN_NO_THREAD_SOCKET to a non-empty value other than "0"
+ * in the environment turns them off.
+ */
+static void thread_handle_init(void)
+{
+	const char *env = getenv("LIBSOCKETCAN_NO_THREAD_SOCKET");
 
-				break;
-			case GET_RESTART_MS:
-				if (can_attr[IFLA_CAN_RESTART_MS]) {
-					*((__u32 *) res) = *((__u32 *)
-							     RTA_DATA(can_attr
-								      [IFLA_CAN_RESTART_MS]));
-					ret = 0;
-				} else
-					fprintf(stderr, "no restart_ms data found\n");
+	if (env != NULL && *env != '\0' && strcmp(env, "0") != 0)
+		return;
 
-				break;
-			case GET_BITTIMING:
-				if (can_attr[IFLA_CAN_BITTIMING]) {
-					memcpy(res,
-					       RTA_DATA(can_attr[IFLA_CAN_BITTIMING]),
-					       sizeof(struct can_bittiming));
-					ret = 0;
-				} else
-					fprintf(stderr, "no bittiming data found\n");
+	if (pthread_key_create(&thread_handle_key, thread_handle_free) != 0)
+		return;
 
-				break;
-			case GET_CTRLMODE:
-				if (can_attr[IFLA_CAN_CTRLMODE]) {
-					memcpy(res,
-					       RTA_DATA(can_attr[IFLA_CAN_CTRLMODE]),
-					       sizeof(struct can_ctrlmode));
-					ret = 0;
-				} else
-					fprintf(stderr, "no ctrlmode data found\n");
+	pthread_atfork(NULL, NULL, thread_handle_atfork);
+	thread_handle_enabled = 1;
+}
 
-				break;
-			case GET_CLOCK:
-				if (can_attr[IFLA_CAN_CLOCK]) {
-					memcpy(res,
-					       RTA_DATA(can_attr[IFLA_CAN_CLOCK]),
-					       sizeof(struct can_clock));
-					ret = 0;
-				} else
-					fprintf(stderr,
-						"no clock parameter data found\n");
+/**
+ * @ingroup intern
+ * @brief handle_drain - discard everything queued on the socket of a handle
+ *
+ * @param h handle to a priorly opened netlink socket
+ */
+static void handle_drain(struct can_handle *h)
+{
+	while (1) {
+		/* a zero length read discards the whole datagram */
+		if (recv(h->fd, NULL, 0, MSG_DONTWAIT) >= 0)
+			continue;
+		if (errno == EINTR || errno == ENOBUFS)
+			continue;
+		break;
+	}
+}
+#endif
 
-				break;
-			case GET_BITTIMING_CONST:
-				if (can_attr[IFLA_CAN_BITTIMING_CONST]) {
-					memcpy(res,
-					       RTA_DATA(can_attr[IFLA_CAN_BITTIMING_CONST]),
-					       sizeof(struct can_bittiming_const));
-					ret = 0;
-				} else
-					fprintf(stderr, "no bittiming_const data found\n");
+/**
+ * @ingroup intern
+ * @brief tmp_handle_get - get a handle for a call without a handle
+ *
+ * The handle-less API reuses one handle per thread, which is opened by the
+ * first call of the thread and closed when the thread exits. A handle
+ * inherited across fork shares its socket with the parent process, the child
+ * opens a new one instead. Replies left over from an aborted request are
+ * discarded before the handle is reused. A call nested into another one, e.g.
+ * from the callback of can_foreach_link, and all calls with the per-thread
+ * handles turned off get a new handle.
+ *
+ * @return handle if success, to be released with tmp_handle_put
+ * @return NULL if failed
+ */
+static struct can_handle *tmp_handle_get(void)
+{
+#ifdef THREAD_SOCKET
+	struct thread_handle *t;
+
+	pthread_once(&thread_handle_once, thread_handle_init);
+	if (!thread_handle_enabled)
+		return can_handle_open();
+
+	t = pthread_getspecific(thread_handle_key);
+	if (t == NULL) {
+		t = calloc(1, sizeof(*t));
+		if (t == NULL)
+			return can_handle_open();
+		if (pthread_setspecific(thread_handle_key, t) != 0) {
+			free(t);
+			return can_handle_open();
+		}
+	}
 
-				break;
-			case GET_BERR_COUNTER:
-				if (can_attr[IFLA_CAN_BERR_COUNTER]) {
-					memcpy(res,
-					       RTA_DATA(can_attr[IFLA_CAN_BERR_COUNTER]),
-					       sizeof(struct can_berr_counter));
-					ret = 0;
-				} else
-					fprintf(stderr, "no berr_counter data found\n");
+	if (t->busy)
+		return can_handle_open();
 
-				break;
-			case GET_DATA_BITTIMING:
-				if (can_attr[IFLA_CAN_DATA_BITTIMING]) {
-					memcpy(res,
-					       RTA_DATA(can_attr[IFLA_CAN_DATA_BITTIMING]),
-					       sizeof(struct can_bittiming));
-					ret = 0;
-				} else
-					fprintf(stderr, "no bittiming data found\n");
+	if (t->h != NULL && t->fork_gen != fork_gen) {
+		/* closes the copy of the parent's socket only */
+		can_handle_close(t->h);
+		t->h = NULL;
+	}
 
-				break;
-			case GET_DATA_BITTIMING_CONST:
-				if (can_attr[IFLA_CAN_DATA_BITTIMING_CONST]) {
-					memcpy(res,
-					       RTA_DATA(can_attr[IFLA_CAN_DATA_BITTIMING_CONST]),
-					       sizeof(struct can_bittiming_const));
-					ret = 0;
-				} else
-					fprintf(stderr, "no bittiming_const data found\n");
+	if (t->h == NULL) {
+		t->h = can_handle_open();
+		if (t->h == NULL)
+			return NULL;
+		t->fork_gen = fork_gen;
+	} else {
+		handle_drain(t->h);
+	}
 
-				break;
-			default:
-				fprintf(stderr, "unknown acquire mode\n");
-			}
+	t->busy = 1;
+
+	return t->h;
+#else
+	return can_handle_open();
+#endif
+}
+
+/**
+ * @ingroup intern
+ * @brief tmp_handle_put - release a handle got from tmp_handle_get
+ *
+ * @param h handle as returned by tmp_handle_get
+ */
+static void tmp_handle_put(struct can_handle *h)
+{
+#ifdef THREAD_SOCKET
+	struct thread_handle *t;
+
+	if (h != NULL && thread_handle_enabled) {
+		t = pthread_getspecific(thread_handle_key);
+		if (t != NULL && t->h == h) {
+			t->busy = 0;
+			return;
 		}
 	}
+#endif
+	can_handle_close(h);
+}
 
-	return ret;
+/**
+ * @ingroup intern
+ * @brief copy_attr - copy the payload of an attribute into a struct
+ *
+ * @param dst pointer to the destination struct
+ * @param size size of the destination struct
+ * @param rta attribute to copy
+ *
+ * Copies at most size bytes. If the kernel sent a shorter payload (e.g. an
+ * older version of the struct), the remainder is zeroed.
+ */
+static void copy_attr(void *dst, size_t size, struct rtattr *rta)
+{
+	size_t len = RTA_PAYLOAD(rta);
+
+	if (len > size)
+		len = size;
+
+	memset(dst, 0, size);
+	memcpy(dst, RTA_DATA(rta), len);
 }
 
 /**
  * @ingroup intern
- * @brief get_link - get linkinfo
+ * @brief fill_link_info - decode a RTM_NEWLINK message
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
+ * @param ifi interface info message header
+ * @param tb parsed IFLA_* attributes of the message
+ * @param info pointer to the snapshot to fill
+ *
+ * Decodes every CAN related attribute of a link message into info and sets
+ * the corresponding CAN_LINK_INFO_* bit in info->valid for each attribute
+ * found.
+ */
+static void fill_link_info(struct ifinfomsg *ifi, struct rtattr **tb,
+			   struct can_link_info *info)
+{
+	struct rtattr *linkinfo[IFLA_INFO_MAX + 1];
+	struct rtattr *can_attr[IFLA_CAN_MAX + 1];
+
+	memset(info, 0, sizeof(*info));
+
+	info->ifindex = ifi->ifi_index;
+	info->flags = ifi->ifi_flags;
+	if (tb[IFLA_IFNAME])
+		strncpy(info->name, RTA_DATA(tb[IFLA_IFNAME]),
+			sizeof(info->name) - 1);
+
+	if (tb[IFLA_STATS64]) {
+		copy_attr(&info->link_stats, sizeof(info->link_stats),
+			  tb[IFLA_STATS64]);
+		info->valid |= CAN_LINK_INFO_LINK_STATS;
+	}
+
+	if (!tb[IFLA_LINKINFO])
+		return;
+
+	parse_rtattr_nested(linkinfo, IFLA_INFO_MAX, tb[IFLA_LINKINFO]);
+
+	if (linkinfo[IFLA_INFO_XSTATS]) {
+		copy_attr(&info->device_stats, sizeof(info->device_stats),
+			  linkinfo[IFLA_INFO_XSTATS]);
+		info->valid |= CAN_LINK_INFO_DEVICE_STATS;
+	}
+
+	if (!linkinfo[IFLA_INFO_DATA])
+		return;
+
+	parse_rtattr_nested(can_attr, IFLA_CAN_MAX, linkinfo[IFLA_INFO_DATA]);
+
+	if (can_attr[IFLA_CAN_STATE]) {
+		info->state = *((__u32 *)RTA_DATA(can_attr[IFLA_CAN_STATE]));
+		info->valid |= CAN_LINK_INFO_STATE;
+	}
+
+	if (can_attr[IFLA_CAN_RESTART_MS]) {
+		info->restart_ms =
+		    *((__u32 *)RTA_DATA(can_attr[IFLA_CAN_RESTART_MS]));
+		info->valid |= CAN_LINK_INFO_RESTART_MS;
+	}
+
+	if (can_attr[IFLA_CAN_BITTIMING]) {
+		copy_attr(&info->bittiming, sizeof(info->bittiming),
+			  can_attr[IFLA_CAN_BITTIMING]);
+		info->valid |= CAN_LINK_INFO_BITTIMING;
+	}
+
+	if (can_attr[IFLA_CAN_CTRLMODE]) {
+		copy_attr(&info->ctrlmode, sizeof(info->ctrlmode),
+			  can_attr[IFLA_CAN_CTRLMODE]);
+		info->valid |= CAN_LINK_INFO_CTRLMODE;
+	}
+
+	if (can_attr[IFLA_CAN_CLOCK]) {
+		copy_attr(&info->clock, sizeof(info->clock),
+			  can_attr[IFLA_CAN_CLOCK]);
+		info->valid |= CAN_LINK_INFO_CLOCK;
+	}
+
+	if (can_attr[IFLA_CAN_BITTIMING_CONST]) {
+		copy_attr(&info->bittiming_const, sizeof(info->bittiming_const),
+			  can_attr[IFLA_CAN_BITTIMING_CONST]);
+		info->valid |= CAN_LINK_INFO_BITTIMING_CONST;
+	}
+
+	if (can_attr[IFLA_CAN_BERR_COUNTER]) {
+		copy_attr(&info->berr_counter, sizeof(info->berr_counter),
+			  can_attr[IFLA_CAN_BERR_COUNTER]);
+		info->valid |= CAN_LINK_INFO_BERR_COUNTER;
+	}
+
+	if (can_attr[IFLA_CAN_DATA_BITTIMING]) {
+		copy_attr(&info->data_bittiming, sizeof(info->data_bittiming),
+			  can_attr[IFLA_CAN_DATA_BITTIMING]);
+		info->valid |= CAN_LINK_INFO_DATA_BITTIMING;
+	}
+
+	if (can_attr[IFLA_CAN_DATA_BITTIMING_CONST]) {
+		copy_attr(&info->data_bittiming_const,
+			  sizeof(info->data_bittiming_const),
+			  can_attr[IFLA_CAN_DATA_BITTIMING_CONST]);
+		info->valid |= CAN_LINK_INFO_DATA_BITTIMING_CONST;
+	}
+
+	if (can_attr[IFLA_CAN_CTRLMODE_EXT]) {
+		struct rtattr *ext_attr[IFLA_CAN_CTRLMODE_MAX + 1];
+
+		parse_rtattr_nested(ext_attr, IFLA_CAN_CTRLMODE_MAX,
+				    can_attr[IFLA_CAN_CTRLMODE_EXT]);
+		if (ext_attr[IFLA_CAN_CTRLMODE_SUPPORTED]) {
+			info->ctrlmode_supported = *((__u32 *)
+			    RTA_DATA(ext_attr[IFLA_CAN_CTRLMODE_SUPPORTED]));
+			info->valid |= CAN_LINK_INFO_CTRLMODE_SUPPORTED;
+		}
+	}
+}
+
+/**
+ * @ingroup intern
+ * @brief caps_from_info - extract the static capabilities from a link snapshot
+ *
+ * @param info snapshot as filled by fill_link_info
+ * @param caps pointer to store the capabilities
+ */
+static void caps_from_info(const struct can_link_info *info,
+			   struct can_caps *caps)
+{
+	memset(caps, 0, sizeof(*caps));
+
+	caps->ifindex = info->ifindex;
+	if (info->valid & CAN_LINK_INFO_CLOCK) {
+		caps->clock = info->clock;
+		caps->valid |= CAN_CAPS_CLOCK;
+	}
+	if (info->valid & CAN_LINK_INFO_BITTIMING_CONST) {
+		caps->bittiming_const = info->bittiming_const;
+		caps->valid |= CAN_CAPS_BITTIMING_CONST;
+	}
+	if (info->valid & CAN_LINK_INFO_DATA_BITTIMING_CONST) {
+		caps->data_bittiming_const = info->data_bittiming_const;
+		caps->valid |= CAN_CAPS_DATA_BITTIMING_CONST;
+	}
+	if (info->valid & CAN_LINK_INFO_CTRLMODE_SUPPORTED) {
+		caps->ctrlmode_supported = info->ctrlmode_supported;
+		caps->valid |= CAN_CAPS_CTRLMODE_SUPPORTED;
+	}
+}
+
+/**
+ * @ingroup intern
+ * @brief get_link_field - extract one parameter from a link snapshot
+ *
+ * @param info snapshot as filled by fill_link_info
  * @param acquire which parameter we want to get
  * @param res pointer to store the result
  *
- * This is a wrapper for do_get_nl_link
- *
  * @return 0 if success
- * @return -1 if failed
+ * @return -1 if the parameter is not present in the snapshot
+ */
+static int get_link_field(const struct can_link_info *info, __u8 acquire,
+			  void *res)
+{
+	switch (acquire) {
+	case GET_LINK_INFO:
+		memcpy(res, info, sizeof(*info));
+		return 0;
+	case GET_IFINDEX:
+		*((int *)res) = info->ifindex;
+		return 0;
+	case GET_FLAGS:
+		*((unsigned int *)res) = info->flags;
+		return 0;
+	case GET_CAPS:
+		caps_from_info(info, res);
+		return 0;
+	case GET_LINK_STATS:
+		if (info->valid & CAN_LINK_INFO_LINK_STATS) {
+			memcpy(res, &info->link_stats,
+			       sizeof(struct rtnl_link_stats64));
+			return 0;
+		}
+		fprintf(stderr, "no link statistics (64-bit) found\n");
+		break;
+	case GET_XSTATS:
+		if (info->valid & CAN_LINK_INFO_DEVICE_STATS) {
+			memcpy(res, &info->device_stats,
+			       sizeof(struct can_device_stats));
+			return 0;
+		}
+		fprintf(stderr, "no can statistics found\n");
+		break;
+	case GET_STATE:
+		if (info->valid & CAN_LINK_INFO_STATE) {
+			*((int *)res) = info->state;
+			return 0;
+		}
+		fprintf(stderr, "no state data found\n");
+		break;
+	case GET_RESTART_MS:
+		if (info->valid & CAN_LINK_INFO_RESTART_MS) {
+			*((__u32 *) res) = info->restart_ms;
+			return 0;
+		}
+		fprintf(stderr, "no restart_ms data found\n");
+		break;
+	case GET_BITTIMING:
+		if (info->valid & CAN_LINK_INFO_BITTIMING) {
+			memcpy(res, &info->bittiming,
+			       sizeof(struct can_bittiming));
+			return 0;
+		}
+		fprintf(stderr, "no bittiming data found\n");
+		break;
+	case GET_CTRLMODE:
+		if (info->valid & CAN_LINK_INFO_CTRLMODE) {
+			memcpy(res, &info->ctrlmode,
+			       sizeof(struct can_ctrlmode));
+			return 0;
+		}
+		fprintf(stderr, "no ctrlmode data found\n");
+		break;
+	case GET_CLOCK:
+		if (info->valid & CAN_LINK_INFO_CLOCK) {
+			memcpy(res, &info->clock, sizeof(struct can_clock));
+			return 0;
+		}
+		fprintf(stderr, "no clock parameter data found\n");
+		break;
+	case GET_BITTIMING_CONST:
+		if (info->valid & CAN_LINK_INFO_BITTIMING_CONST) {
+			memcpy(res, &info->bittiming_const,
+			       sizeof(struct can_bittiming_const));
+			return 0;
+		}
+		fprintf(stderr, "no bittiming_const data found\n");
+		break;
+	case GET_BERR_COUNTER:
+		if (info->valid & CAN_LINK_INFO_BERR_COUNTER) {
+			memcpy(res, &info->berr_counter,
+			       sizeof(struct can_berr_counter));
+			return 0;
+		}
+		fprintf(stderr, "no berr_counter data found\n");
+		break;
+	case GET_DATA_BITTIMING:
+		if (info->valid & CAN_LINK_INFO_DATA_BITTIMING) {
+			memcpy(res, &info->data_bittiming,
+			       sizeof(struct can_bittiming));
+			return 0;
+		}
+		fprintf(stderr, "no bittiming data found\n");
+		break;
+	case GET_DATA_BITTIMING_CONST:
+		if (info->valid & CAN_LINK_INFO_DATA_BITTIMING_CONST) {
+			memcpy(res, &info->data_bittiming_const,
+			       sizeof(struct can_bittiming_const));
+			return 0;
+		}
+		fprintf(stderr, "no bittiming_const data found\n");
+		break;
+	default:
+		fprintf(stderr, "unknown acquire mode\n");
+	}
+
+	return -1;
+}
+
+/**
+ * @ingroup intern
+ * @brief is_can_link - check the link kind of a RTM_NEWLINK message
+ *
+ * @param tb parsed IFLA_* attributes of the message
+ *
+ * @return 1 if IFLA_INFO_KIND is "can"
+ * @return 0 otherwise
  */
-static int get_link(const char *name, __u8 acquire, void *res)
+static int is_can_link(struct rtattr **tb)
 {
-	int err, fd;
+	struct rtattr *linkinfo[IFLA_INFO_MAX + 1];
+	const char *kind;
 
-	fd = open_nl_sock();
-	if (fd < 0)
-		return -1;
+	if (!tb[IFLA_LINKINFO])
+		return 0;
 
-	err = do_get_nl_link(fd, acquire, name, res);
-	close(fd);
+	parse_rtattr_nested(linkinfo, IFLA_INFO_MAX, tb[IFLA_LINKINFO]);
+	if (!linkinfo[IFLA_INFO_KIND])
+		return 0;
 
-	return err;
+	kind = RTA_DATA(linkinfo[IFLA_INFO_KIND]);
 
+	return strncmp(kind, "can", RTA_PAYLOAD(linkinfo[IFLA_INFO_KIND])) == 0;
 }
 
 /**
  * @ingroup intern
- * @brief do_set_nl_link - setup linkinfo
+ * @brief walk_nl_link - get linkinfo of one or all can interfaces
  *
- * @param fd socket file descriptor to a priorly opened netlink socket
- * @param if_state state of the interface we want to put the device into. this
- * parameter is only set if you want to use the callback to driver up/down the
- * device
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param req_info request parameters
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index if name is NULL, or 0 to dump all can
+ * interfaces
+ * @param cb callback invoked with the snapshot of every matching link
+ * @param data user pointer passed to cb
+ * @param ext_mask RTEXT_FILTER_* flags for the request, e.g.
+ * RTEXT_FILTER_SKIP_STATS to drop the per address family and VF statistics,
+ * the link statistics are reported regardless
  *
- * This callback can do two different tasks:
- * - bring up/down the interface
- * - set up a netlink packet with request, as set up in req_info
- * Which task this callback will do depends on which parameters are set.
+ * This callback send a dump request into the netlink layer and decodes every
+ * RTM_NEWLINK packet of the reply into a struct can_link_info. If name or
+ * ifindex is given, only this link is reported. Otherwise every link of
+ * kind "can" is reported. If cb returns non-zero, no further links are
+ * reported, but the rest of the dump is still read from the socket so that it
+ * is clean for the next request.
+ *
+ * @return number of links reported to cb if success
+ * @return -1 if failed
+ */
+static int walk_nl_link(struct can_handle *h, const char *name,
+			int ifindex, can_link_info_cb cb, void *data,
+			__u32 ext_mask)
+{
+	struct rx_buf tmp, *rx;
+
+	int ret = 0;
+	int done = 0;
+	int stop = 0;
+	int lost = 0;
+
+	struct nlmsghdr *nl_msg;
+	ssize_t msglen;
+
+	struct can_link_info info;
+	__u32 seq = next_seq(h);
+
+	if (send_dump_request(h, name, ifindex, AF_PACKET, RTM_GETLINK, seq,
+			      ext_mask) < 0) {
+		perror("Cannot send dump request");
+		return -1;
+	}
+
+	rx = rx_begin(h, &tmp);
+	while (!done) {
+		size_t u_msglen;
+
+		msglen = rx_recv_reply(h, rx, &lost);
+		if (msglen <= 0)
+			break;
+
+		u_msglen = (size_t) msglen;
+
+		for (nl_msg = (struct nlmsghdr *)rx->buf;
+		     NLMSG_OK(nl_msg, u_msglen);
+		     nl_msg = NLMSG_NEXT(nl_msg, u_msglen)) {
+			int type = nl_msg->nlmsg_type;
+			int len;
+
+			if (nl_msg->nlmsg_seq != seq) {
+				async_process_msg(h, nl_msg);
+				continue;
+			}
+			if (type == NLMSG_DONE) {
+				done++;
+				continue;
+			}
+			if (type == NLMSG_ERROR) {
+				nl_perror(h, ack_error(h, nl_msg));
+				ret = -1;
+				goto out;
+			}
+			if (type != RTM_NEWLINK)
+				continue;
+
+			struct ifinfomsg *ifi = NLMSG_DATA(nl_msg);
+			struct rtattr *tb[IFLA_MAX + 1];
+
+			len =
+				nl_msg->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+			parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), len);
+
+			if (name != NULL || ifindex > 0) {
+				/* the single reply to a request by name or index */
+				done++;
+			} else if (!is_can_link(tb)) {
+				continue;
+			}
+
+			if (stop)
+				continue;
+
+			fill_link_info(ifi, tb, &info);
+			ret++;
+			if (cb(&info, data))
+				stop = 1;
+		}
+	}
+	if (!done && msglen < 0) {
+		/* a lost reply is reported by do_walk_nl_link */
+		if (errno != ENOBUFS)
+			perror("Cannot receive netlink reply");
+		ret = -1;
+	}
+
+out:
+	rx_end(h, rx);
+
+	return ret;
+}
+
+/**
+ * @ingroup intern
+ * @brief do_walk_nl_link - walk_nl_link, repeated if the reply was lost
+ *
+ * The reply to a request for a single link is dropped if the socket overran.
+ * The socket is drained by then, so the request is sent once more.
+ */
+static int do_walk_nl_link(struct can_handle *h, const char *name,
+			   int ifindex, can_link_info_cb cb, void *data,
+			   __u32 ext_mask)
+{
+	int ret;
+
+	ret = walk_nl_link(h, name, ifindex, cb, data, ext_mask);
+	if (ret < 0 && errno == ENOBUFS && (name != NULL || ifindex > 0))
+		ret = walk_nl_link(h, name, ifindex, cb, data, ext_mask);
+	if (ret < 0 && errno == ENOBUFS) {
+		perror("Cannot receive netlink reply");
+		errno = ENOBUFS;
+	}
+
+	return ret;
+}
+
+static int store_link_info(const struct can_link_info *info, void *data)
+{
+	memcpy(data, info, sizeof(*info));
+
+	return 1;
+}
+
+/**
+ * @ingroup intern
+ * @brief get_nl_stats - get the 64-bit link statistics with RTM_GETSTATS
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ * @param rls pointer to store the statistics
+ *
+ * A RTM_GETSTATS request filtered to IFLA_STATS_LINK_64 is answered with the
+ * statistics only, where a RTM_GETLINK reply carries every attribute of the
+ * link. This makes a difference when polling the counters at a high rate.
+ *
+ * RTM_GETSTATS only takes an interface index, a name is resolved with the
+ * name cache of the handle, which has to be enabled then.
+ *
+ * @return 0 if success
+ * @return 1 if the kernel does not support RTM_GETSTATS
+ * @return -1 if failed
+ */
+static int get_nl_stats(struct can_handle *h, const char *name,
+			int ifindex, struct rtnl_link_stats64 *rls)
+{
+#ifdef RTM_GETSTATS
+	struct {
+		struct nlmsghdr n;
+		struct if_stats_msg ifsm;
+	} req;
+
+	struct rx_buf tmp, *rx;
+	struct nlmsghdr *nl_msg;
+	ssize_t msglen;
+	int lost = 0;
+	int ret = -1;
+
+	memset(&req, 0, sizeof(req));
+
+	req.n.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifsm));
+	req.n.nlmsg_type = RTM_GETSTATS;
+	req.n.nlmsg_flags = NLM_F_REQUEST;
+
+	req.ifsm.family = AF_UNSPEC;
+	req.ifsm.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+	if (name != NULL) {
+		ifindex = can_handle_name_to_index(h, name);
+		if (ifindex < 0)
+			return -1;
+	} else if (ifindex <= 0) {
+		fprintf(stderr, "Invalid interface index %d\n", ifindex);
+		errno = ENODEV;
+		return -1;
+	}
+	req.ifsm.ifindex = ifindex;
+
+	if (send_request(h, &req.n) < 0)
+		return -1;
+
+	rx = rx_begin(h, &tmp);
+	while (1) {
+		size_t u_msglen;
+
+		msglen = rx_recv_reply(h, rx, &lost);
+		if (msglen <= 0)
+			break;
+
+		u_msglen = (size_t) msglen;
+
+		for (nl_msg = (struct nlmsghdr *)rx->buf;
+		     NLMSG_OK(nl_msg, u_msglen);
+		     nl_msg = NLMSG_NEXT(nl_msg, u_msglen)) {
+			struct if_stats_msg *ifsm = NLMSG_DATA(nl_msg);
+			struct rtattr *tb[IFLA_STATS_MAX + 1];
+			int len;
+
+			if (nl_msg->nlmsg_seq != req.n.nlmsg_seq) {
+				async_process_msg(h, nl_msg);
+				continue;
+			}
+			if (nl_msg->nlmsg_type == NLMSG_ERROR) {
+				int err = ack_error(h, nl_msg);
+
+				if (err == -EOPNOTSUPP) {
+					ret = 1;
+					goto out;
+				}
+
+				nl_perror(h, err);
+				goto out;
+			}
+			if (nl_msg->nlmsg_type != RTM_NEWSTATS)
+				continue;
+
+			len = nl_msg->nlmsg_len - NLMSG_LENGTH(sizeof(*ifsm));
+			if (len < 0)
+				continue;
+
+			parse_rtattr(tb, IFLA_STATS_MAX,
+				     (struct rtattr *)((char *)ifsm +
+						       NLMSG_ALIGN(sizeof(*ifsm))),
+				     len);
+			if (!tb[IFLA_STATS_LINK_64]) {
+				fprintf(stderr, "no link statistics (64-bit) found\n");
+				goto out;
+			}
+
+			copy_attr(rls, sizeof(*rls), tb[IFLA_STATS_LINK_64]);
+			ret = 0;
+			goto out;
+		}
+	}
+
+	/* a lost reply is reported by do_get_nl_stats */
+	if (errno != ENOBUFS)
+		perror("Cannot receive netlink reply");
+out:
+	rx_end(h, rx);
+
+	return ret;
+#else
+	return 1;
+#endif
+}
+
+/**
+ * @ingroup intern
+ * @brief do_get_nl_stats - get_nl_stats, repeated if the reply was lost
+ *
+ * See do_walk_nl_link.
+ */
+static int do_get_nl_stats(struct can_handle *h, const char *name,
+			   int ifindex, struct rtnl_link_stats64 *rls)
+{
+	int ret;
+
+	ret = get_nl_stats(h, name, ifindex, rls);
+	if (ret < 0 && errno == ENOBUFS)
+		ret = get_nl_stats(h, name, ifindex, rls);
+	if (ret < 0 && errno == ENOBUFS) {
+		perror("Cannot receive netlink reply");
+		errno = ENOBUFS;
+	}
+
+	return ret;
+}
+
+/**
+ * @ingroup intern
+ * @brief do_get_nl_link - get linkinfo
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param acquire  which parameter we want to get
+ * @param name name of the can device. This is the netdev name, as ifconfig -a
+ * shows in your system. usually it contains prefix "can" and the numer of the
+ * can line. e.g. "can0". NULL to address the device by ifindex
+ * @param ifindex interface index, used if name is NULL
+ * @param res pointer to store the result
+ *
+ * This callback collects the linkinfo of the device with do_walk_nl_link and
+ * fills the pointer res points to depending on the acquire mode set in param
+ * acquire.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int do_get_nl_link(struct can_handle *h, __u8 acquire, const char *name,
+			  int ifindex, void *res)
+{
+	struct can_link_info info;
+
+	/*
+	 * Without the name cache, resolving a name for RTM_GETSTATS would cost
+	 * more than the RTM_GETLINK reply by name saves.
+	 */
+	if (acquire == GET_LINK_STATS && !h->no_getstats &&
+	    (name == NULL || h->name_cache)) {
+		int ret = do_get_nl_stats(h, name, ifindex, res);
+
+		if (ret <= 0)
+			return ret;
+
+		/* remember and take the RTM_GETLINK path from now on */
+		h->no_getstats = 1;
+	}
+
+	/*
+	 * The flag drops the per address family statistics in IFLA_AF_SPEC,
+	 * which are never used. IFLA_STATS64 and the can device statistics
+	 * are sent regardless.
+	 */
+	if (do_walk_nl_link(h, name, ifindex, store_link_info, &info,
+			    RTEXT_FILTER_SKIP_STATS) <= 0)
+		return -1;
+
+	return get_link_field(&info, acquire, res);
+}
+
+/**
+ * @ingroup intern
+ * @brief name_cache_set - add or update a name cache entry
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param ifindex interface index
+ * @param name current name of the interface
+ */
+static void name_cache_set(struct can_handle *h, int ifindex, const char *name)
+{
+	struct link_name *n;
+	int i;
+
+	for (i = 0; i < h->nnames; i++)
+		if (h->names[i].ifindex == ifindex)
+			break;
+
+	if (i == h->nnames) {
+		if (h->nnames == h->names_alloc) {
+			int alloc = h->names_alloc ? 2 * h->names_alloc : 8;
+
+			n = realloc(h->names, alloc * sizeof(*n));
+			if (n == NULL) {
+				/* try again with the next lookup */
+				h->names_stale = 1;
+				return;
+			}
+			h->names = n;
+			h->names_alloc = alloc;
+		}
+		h->nnames++;
+	}
+
+	n = &h->names[i];
+	n->ifindex = ifindex;
+	strncpy(n->name, name, sizeof(n->name) - 1);
+	n->name[sizeof(n->name) - 1] = '\0';
+}
+
+/**
+ * @ingroup intern
+ * @brief name_cache_del - remove a name cache entry
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param ifindex interface index
+ */
+static void name_cache_del(struct can_handle *h, int ifindex)
+{
+	int i;
+
+	for (i = 0; i < h->nnames; i++) {
+		if (h->names[i].ifindex == ifindex) {
+			h->names[i] = h->names[--h->nnames];
+			return;
+		}
+	}
+}
+
+/**
+ * @ingroup intern
+ * @brief name_cache_process - apply a link notification to the name cache
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param nl_msg received netlink message
+ *
+ * A RTM_NEWLINK notification adds or renames the entry of a can link, a
+ * RTM_DELLINK notification removes it.
+ */
+static void name_cache_process(struct can_handle *h, struct nlmsghdr *nl_msg)
+{
+	struct ifinfomsg *ifi = NLMSG_DATA(nl_msg);
+	struct rtattr *tb[IFLA_MAX + 1];
+	int len;
+
+	if (!h->name_cache)
+		return;
+
+	len = nl_msg->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	if (len < 0)
+		return;
+
+	if (nl_msg->nlmsg_type == RTM_DELLINK) {
+		name_cache_del(h, ifi->ifi_index);
+		return;
+	}
+	if (nl_msg->nlmsg_type != RTM_NEWLINK)
+		return;
+
+	parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), len);
+	if (tb[IFLA_IFNAME] && is_can_link(tb))
+		name_cache_set(h, ifi->ifi_index, RTA_DATA(tb[IFLA_IFNAME]));
+}
+
+static int name_cache_fill(const struct can_link_info *info, void *data)
+{
+	name_cache_set(data, info->ifindex, info->name);
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief name_cache_resync - refill the name cache from a link dump
+ *
+ * @param h handle to a priorly opened netlink socket
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int name_cache_resync(struct can_handle *h)
+{
+	h->nnames = 0;
+	h->names_stale = 0;
+
+	if (do_walk_nl_link(h, NULL, 0, name_cache_fill, h,
+			    RTEXT_FILTER_SKIP_STATS) < 0) {
+		h->names_stale = 1;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief caps_find - look up a capability cache entry
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ *
+ * @return pointer to the entry if found
+ * @return NULL otherwise
+ */
+static struct link_caps *caps_find(struct can_handle *h, const char *name,
+				   int ifindex)
+{
+	int i;
+
+	for (i = 0; i < h->ncaps; i++) {
+		if (name != NULL ? strcmp(h->caps[i].name, name) == 0 :
+		    h->caps[i].caps.ifindex == ifindex)
+			return &h->caps[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * @ingroup intern
+ * @brief caps_store - add or replace the capability cache entry of a link
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param info snapshot of the link as filled by fill_link_info
+ *
+ * @return pointer to the entry if success
+ * @return NULL if out of memory
+ */
+static struct link_caps *caps_store(struct can_handle *h,
+				    const struct can_link_info *info)
+{
+	struct link_caps *c;
+
+	c = caps_find(h, NULL, info->ifindex);
+	if (c == NULL) {
+		if (h->ncaps == h->caps_alloc) {
+			int alloc = h->caps_alloc ? 2 * h->caps_alloc : 8;
+
+			c = realloc(h->caps, alloc * sizeof(*c));
+			if (c == NULL)
+				return NULL;
+			h->caps = c;
+			h->caps_alloc = alloc;
+		}
+		c = &h->caps[h->ncaps++];
+	}
+
+	strncpy(c->name, info->name, sizeof(c->name) - 1);
+	c->name[sizeof(c->name) - 1] = '\0';
+	caps_from_info(info, &c->caps);
+
+	return c;
+}
+
+/**
+ * @ingroup intern
+ * @brief caps_cache_process - apply a link notification to the capability cache
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param nl_msg received netlink message
+ *
+ * A RTM_DELLINK notification drops the entry of the link. A RTM_NEWLINK
+ * notification of a cached link replaces its entry, so that a renamed link is
+ * found by its new name and a device registered again under the same index
+ * does not inherit the capabilities of its predecessor. Links which are not
+ * cached are left to the next lookup.
+ */
+static void caps_cache_process(struct can_handle *h, struct nlmsghdr *nl_msg)
+{
+	struct ifinfomsg *ifi = NLMSG_DATA(nl_msg);
+	struct rtattr *tb[IFLA_MAX + 1];
+	struct can_link_info info;
+	struct link_caps *c;
+	int len;
+
+	if (!h->caps_cache)
+		return;
+
+	len = nl_msg->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	if (len < 0)
+		return;
+
+	c = caps_find(h, NULL, ifi->ifi_index);
+	if (c == NULL)
+		return;
+
+	if (nl_msg->nlmsg_type == RTM_DELLINK) {
+		*c = h->caps[--h->ncaps];
+		return;
+	}
+	if (nl_msg->nlmsg_type != RTM_NEWLINK)
+		return;
+
+	parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), len);
+	fill_link_info(ifi, tb, &info);
+	caps_store(h, &info);
+}
+
+static int caps_cache_fill(const struct can_link_info *info, void *data)
+{
+	/* entries which do not fit are added by the next lookup */
+	caps_store(data, info);
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief caps_lookup - get the capabilities of a link through the cache
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ * @param caps pointer to store the capabilities
+ *
+ * A link which is not cached yet is queried from the kernel and added to the
+ * cache.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int caps_lookup(struct can_handle *h, const char *name, int ifindex,
+		       struct can_caps *caps)
+{
+	struct can_link_info info;
+	struct link_caps *c;
+
+	c = caps_find(h, name, ifindex);
+	if (c != NULL) {
+		memcpy(caps, &c->caps, sizeof(*caps));
+		return 0;
+	}
+
+	if (do_walk_nl_link(h, name, ifindex, store_link_info, &info,
+			    RTEXT_FILTER_SKIP_STATS) <= 0)
+		return -1;
+
+	caps_store(h, &info);
+	caps_from_info(&info, caps);
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief caps_get_field - get one static parameter through the capability cache
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ * @param acquire GET_CAPS, GET_CLOCK, GET_BITTIMING_CONST or
+ * GET_DATA_BITTIMING_CONST
+ * @param res pointer to store the result
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int caps_get_field(struct can_handle *h, const char *name, int ifindex,
+			  __u8 acquire, void *res)
+{
+	struct can_caps caps;
+
+	if (caps_lookup(h, name, ifindex, &caps) < 0)
+		return -1;
+
+	switch (acquire) {
+	case GET_CAPS:
+		memcpy(res, &caps, sizeof(caps));
+		return 0;
+	case GET_CLOCK:
+		if (caps.valid & CAN_CAPS_CLOCK) {
+			memcpy(res, &caps.clock, sizeof(struct can_clock));
+			return 0;
+		}
+		fprintf(stderr, "no clock parameter data found\n");
+		break;
+	case GET_BITTIMING_CONST:
+		if (caps.valid & CAN_CAPS_BITTIMING_CONST) {
+			memcpy(res, &caps.bittiming_const,
+			       sizeof(struct can_bittiming_const));
+			return 0;
+		}
+		fprintf(stderr, "no bittiming_const data found\n");
+		break;
+	case GET_DATA_BITTIMING_CONST:
+		if (caps.valid & CAN_CAPS_DATA_BITTIMING_CONST) {
+			memcpy(res, &caps.data_bittiming_const,
+			       sizeof(struct can_bittiming_const));
+			return 0;
+		}
+		fprintf(stderr, "no bittiming_const data found\n");
+		break;
+	default:
+		fprintf(stderr, "unknown acquire mode\n");
+	}
+
+	return -1;
+}
+
+/**
+ * @ingroup intern
+ * @brief coalesce_invalidate - mark all coalescing snapshots as outdated
+ *
+ * @param h handle to a priorly opened netlink socket
+ *
+ * Called after every modification request, so that no caller is served the
+ * link state from before the change. Queries running meanwhile do not publish
+ * their result for later callers either.
+ */
+static void coalesce_invalidate(struct can_handle *h)
+{
+#ifdef HAVE_PTHREAD
+	struct snapshot *s;
+
+	if (!h->coalesce)
+		return;
+
+	pthread_mutex_lock(&h->coalesce_lock);
+	h->mod_gen++;
+	for (s = h->snapshots; s != NULL; s = s->next)
+		s->valid = 0;
+	pthread_mutex_unlock(&h->coalesce_lock);
+#endif
+}
+
+#ifdef HAVE_PTHREAD
+/**
+ * @ingroup intern
+ * @brief snapshot_get - find or create the coalescing snapshot of a link
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ *
+ * Must be called with coalesce_lock held.
+ *
+ * @return pointer to the snapshot if success
+ * @return NULL if out of memory
+ */
+static struct snapshot *snapshot_get(struct can_handle *h, const char *name,
+				     int ifindex)
+{
+	struct snapshot *s;
+
+	for (s = h->snapshots; s != NULL; s = s->next) {
+		if (name != NULL ? strcmp(s->name, name) == 0 :
+		    s->name[0] == '\0' && s->ifindex == ifindex)
+			return s;
+	}
+
+	s = calloc(1, sizeof(*s));
+	if (s == NULL) {
+		perror("Cannot allocate snapshot");
+		return NULL;
+	}
+
+	if (name != NULL)
+		strncpy(s->name, name, sizeof(s->name) - 1);
+	else
+		s->ifindex = ifindex;
+	s->next = h->snapshots;
+	h->snapshots = s;
+
+	return s;
+}
+
+/**
+ * @ingroup intern
+ * @brief coalesce_get - get linkinfo through the coalescing layer
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ * @param acquire which parameter we want to get
+ * @param res pointer to store the result
+ *
+ * If a query for the same link is running, the caller waits for its result.
+ * If the last query completed within the freshness window, its result is
+ * used. Otherwise the caller queries the kernel and shares the result with
+ * the callers arriving meanwhile.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int coalesce_get(struct can_handle *h, const char *name, int ifindex,
+			__u8 acquire, void *res)
+{
+	struct can_link_info info;
+	struct snapshot *s;
+	unsigned int gen;
+	int err;
+	int ret;
+
+	pthread_mutex_lock(&h->coalesce_lock);
+
+	s = snapshot_get(h, name, ifindex);
+	if (s == NULL) {
+		pthread_mutex_unlock(&h->coalesce_lock);
+		return -1;
+	}
+
+	if (s->in_flight) {
+		gen = s->gen;
+		while (s->gen == gen)
+			pthread_cond_wait(&h->coalesce_cond, &h->coalesce_lock);
+		h->coalesce_stats.merged_in_flight++;
+	} else if (s->valid &&
+		   monotonic_us() - s->done_us <= h->coalesce_window_us) {
+		h->coalesce_stats.merged_fresh++;
+	} else {
+		gen = h->mod_gen;
+		s->in_flight = 1;
+		pthread_mutex_unlock(&h->coalesce_lock);
+
+		pthread_mutex_lock(&h->io_lock);
+		ret = do_walk_nl_link(h, name, ifindex, store_link_info, &info,
+				      RTEXT_FILTER_SKIP_STATS);
+		/* take errno before anything else can change it */
+		if (ret > 0)
+			err = 0;
+		else if (ret == 0)
+			err = ENODEV;
+		else
+			err = errno;
+		pthread_mutex_unlock(&h->io_lock);
+
+		pthread_mutex_lock(&h->coalesce_lock);
+		s->in_flight = 0;
+		s->gen++;
+		s->err = err;
+		if (!err)
+			memcpy(&s->info, &info, sizeof(info));
+		/* a modification meanwhile makes the result unfit for reuse */
+		s->valid = !err && gen == h->mod_gen;
+		s->done_us = monotonic_us();
+		h->coalesce_stats.queries++;
+		pthread_cond_broadcast(&h->coalesce_cond);
+	}
+
+	err = s->err;
+	if (!err)
+		memcpy(&info, &s->info, sizeof(info));
+	pthread_mutex_unlock(&h->coalesce_lock);
+
+	if (err) {
+		errno = err;
+		return -1;
+	}
+
+	return get_link_field(&info, acquire, res);
+}
+#endif
+
+/**
+ * @ingroup intern
+ * @brief async_process_msg - complete an outstanding async request
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param nl_msg received netlink message
+ *
+ * Looks up the outstanding request by the sequence number of the message.
+ * If the message completes it, the request is removed and its callback is
+ * invoked. Notifications update the name and capability caches.
+ *
+ * @return 1 if a request was completed
+ * @return 0 if the message was ignored
+ */
+static int async_process_msg(struct can_handle *h, struct nlmsghdr *nl_msg)
+{
+	struct async_req **pp, *req;
+	struct can_link_info info;
+	int err = 0;
+
+	if (nl_msg->nlmsg_seq == 0) {
+		name_cache_process(h, nl_msg);
+		caps_cache_process(h, nl_msg);
+		return 0;
+	}
+
+	for (pp = &h->pending; *pp != NULL; pp = &(*pp)->next)
+		if ((*pp)->seq == nl_msg->nlmsg_seq)
+			break;
+
+	req = *pp;
+	if (req == NULL)
+		return 0;
+
+	if (nl_msg->nlmsg_type == NLMSG_ERROR) {
+		err = ack_error(h, nl_msg);
+	} else if (req->get && nl_msg->nlmsg_type == RTM_NEWLINK) {
+		struct ifinfomsg *ifi = NLMSG_DATA(nl_msg);
+		struct rtattr *tb[IFLA_MAX + 1];
+		int len;
+
+		len = nl_msg->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+		if (len < 0)
+			return 0;
+
+		parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), len);
+		fill_link_info(ifi, tb, &info);
+	} else {
+		return 0;
+	}
+
+	/* unlink first, the callback may submit new requests */
+	*pp = req->next;
+	req->cb(h, req->seq, err, (req->get && !err) ? &info : NULL,
+		req->data);
+	free(req);
+
+	return 1;
+}
+
+/**
+ * @ingroup intern
+ * @brief async_add - register an outstanding async request
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param seq sequence number of the request
+ * @param get 1 if the request is completed by a RTM_NEWLINK reply
+ * @param cb completion callback
+ * @param data user pointer passed to cb
+ *
+ * @return sequence number if success
+ * @return -1 if failed
+ */
+static int async_add(struct can_handle *h, __u32 seq, int get,
+		     can_async_cb cb, void *data)
+{
+	struct async_req *req;
+
+	req = calloc(1, sizeof(*req));
+	if (req == NULL) {
+		perror("Cannot allocate async request");
+		return -1;
+	}
+
+	req->seq = seq;
+	req->get = get;
+	req->cb = cb;
+	req->data = data;
+	req->next = h->pending;
+	h->pending = req;
+
+	return seq;
+}
+
+/**
+ * @ingroup intern
+ * @brief check_link_id - check how a request addresses the link
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ *
+ * @return 0 if the link is addressed by name or by a valid index
+ * @return -1 otherwise, errno is set to ENODEV
+ */
+static int check_link_id(const char *name, int ifindex)
+{
+	if (name != NULL || ifindex > 0)
+		return 0;
+
+	fprintf(stderr, "Invalid interface index %d\n", ifindex);
+	errno = ENODEV;
+
+	return -1;
+}
+
+/**
+ * @ingroup intern
+ * @brief get_link - get linkinfo
+ *
+ * @param h handle to a priorly opened netlink socket, or NULL
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0". NULL to address the device by ifindex
+ * @param ifindex interface index, used if name is NULL
+ * @param acquire which parameter we want to get
+ * @param res pointer to store the result
+ *
+ * This is a wrapper for do_get_nl_link. If no handle is given, it opens a
+ * temporary one, sends down the request and closes the handle again. The
+ * static parameters are served from the capability cache of the handle if it
+ * is enabled, see can_handle_caps_cache.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int get_link(struct can_handle *h, const char *name, int ifindex,
+		    __u8 acquire, void *res)
+{
+	int err;
+
+	if (check_link_id(name, ifindex) < 0)
+		return -1;
+
+	if (h != NULL && h->caps_cache &&
+	    (acquire == GET_CAPS || acquire == GET_CLOCK ||
+	     acquire == GET_BITTIMING_CONST ||
+	     acquire == GET_DATA_BITTIMING_CONST))
+		return caps_get_field(h, name, ifindex, acquire, res);
+
+#ifdef HAVE_PTHREAD
+	if (h != NULL && h->coalesce)
+		return coalesce_get(h, name, ifindex, acquire, res);
+#endif
+
+	if (h != NULL)
+		return do_get_nl_link(h, acquire, name, ifindex, res);
+
+	h = tmp_handle_get();
+	if (h == NULL)
+		return -1;
+
+	err = do_get_nl_link(h, acquire, name, ifindex, res);
+	tmp_handle_put(h);
+
+	return err;
+}
+
+/**
+ * @ingroup intern
+ * @brief build_set_req - build a linkinfo modification request
+ *
+ * @param req request to fill
+ * @param if_state state of the interface we want to put the device into. this
+ * parameter is only set if you want to use the callback to driver up/down the
+ * device
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0". NULL to address the device by ifindex
+ * @param ifindex interface index, used if name is NULL
+ * @param req_info request parameters
+ *
+ * The request can do two different tasks:
+ * - bring up/down the interface
+ * - set up a netlink packet with request, as set up in req_info
+ * Which task the request will do depends on which parameters are set.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int build_set_req(struct set_req *req, __u8 if_state,
+			 const char *name, int ifindex,
+			 struct req_info *req_info)
+{
+	const char *type = "can";
+
+	memset(req, 0, sizeof(*req));
+
+	req->n.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	req->n.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+	req->n.nlmsg_type = RTM_NEWLINK;
+	req->i.ifi_family = 0;
+
+	/* let the kernel resolve the name, no separate index lookup */
+	if (name == NULL)
+		req->i.ifi_index = ifindex;
+	else if (addattr_l(&req->n, sizeof(*req), IFLA_IFNAME, name,
+			   strlen(name) + 1) < 0)
+		return -1;
+
+	if (if_state) {
+		switch (if_state) {
+		case IF_DOWN:
+			req->i.ifi_change |= IFF_UP;
+			req->i.ifi_flags &= ~IFF_UP;
+			break;
+		case IF_UP:
+			req->i.ifi_change |= IFF_UP;
+			req->i.ifi_flags |= IFF_UP;
+			break;
+		default:
+			fprintf(stderr, "unknown state\n");
+			return -1;
+		}
+	}
+
+	if (req_info != NULL) {
+		/* setup linkinfo section */
+		struct rtattr *linkinfo = NLMSG_TAIL(&req->n);
+		addattr_l(&req->n, sizeof(*req), IFLA_LINKINFO, NULL, 0);
+		addattr_l(&req->n, sizeof(*req), IFLA_INFO_KIND, type,
+			  strlen(type));
+		/* setup data section */
+		struct rtattr *data = NLMSG_TAIL(&req->n);
+		addattr_l(&req->n, sizeof(*req), IFLA_INFO_DATA, NULL, 0);
+
+		if (req_info->restart_ms > 0 || req_info->disable_autorestart)
+			addattr32(&req->n, 1024, IFLA_CAN_RESTART_MS,
+				  req_info->restart_ms);
+
+		if (req_info->restart)
+			addattr32(&req->n, 1024, IFLA_CAN_RESTART, 1);
+
+		if (req_info->bittiming != NULL) {
+			addattr_l(&req->n, 1024, IFLA_CAN_BITTIMING,
+				  req_info->bittiming,
+				  sizeof(struct can_bittiming));
+		}
+
+		if (req_info->dbittiming != NULL) {
+			addattr_l(&req->n, 1024, IFLA_CAN_DATA_BITTIMING,
+				  req_info->dbittiming,
+				  sizeof(struct can_bittiming));
+		}
+
+		if (req_info->ctrlmode != NULL) {
+			addattr_l(&req->n, 1024, IFLA_CAN_CTRLMODE,
+				  req_info->ctrlmode,
+				  sizeof(struct can_ctrlmode));
+		}
+
+		/* mark end of data section */
+		data->rta_len = (void *)NLMSG_TAIL(&req->n) - (void *)data;
+
+		/* mark end of link info section */
+		linkinfo->rta_len =
+		    (void *)NLMSG_TAIL(&req->n) - (void *)linkinfo;
+	}
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief do_set_nl_link - setup linkinfo
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param if_state state of the interface we want to put the device into. this
+ * parameter is only set if you want to use the callback to driver up/down the
+ * device
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0". NULL to address the device by ifindex
+ * @param ifindex interface index, used if name is NULL
+ * @param req_info request parameters
+ *
+ * This builds the request with build_set_req, sends it down and waits for the
+ * status.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int do_set_nl_link(struct can_handle *h, __u8 if_state,
+			  const char *name, int ifindex,
+			  struct req_info *req_info)
+{
+	struct set_req req;
+
+	if (build_set_req(&req, if_state, name, ifindex, req_info) < 0)
+		return -1;
+
+	return send_mod_request(h, &req.n);
+}
+
+/**
+ * @ingroup intern
+ * @brief async_set_link - send a linkinfo modification request asynchronously
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, e.g. "can0"
+ * @param if_state state of the interface we want to put the device into
+ * @param req_info request parameters
+ * @param cb completion callback
+ * @param data user pointer passed to cb
+ *
+ * The kernel applies the request within the send, only the ack is left to
+ * can_handle_dispatch.
+ *
+ * @return sequence number if success
+ * @return -1 if failed
+ */
+static int async_set_link(struct can_handle *h, const char *name,
+			  __u8 if_state, struct req_info *req_info,
+			  can_async_cb cb, void *data)
+{
+	struct set_req req;
+
+	if (build_set_req(&req, if_state, name, 0, req_info) < 0)
+		return -1;
+
+	req.n.nlmsg_flags |= NLM_F_ACK;
+	if (send_request(h, &req.n) < 0)
+		return -1;
+
+	return async_add(h, req.n.nlmsg_seq, 0, cb, data);
+}
+
+/**
+ * @ingroup intern
+ * @brief set_link - open a netlink socket and setup linkinfo
+ *
+ * @param h handle to a priorly opened netlink socket, or NULL
+ * @param name name of the can device. This is the netdev name, as ifconfig -a
+ * shows in your system. usually it contains prefix "can" and the numer of the
+ * can line. e.g. "can0". NULL to address the device by ifindex
+ * @param ifindex interface index, used if name is NULL
+ * @param if_state state of the interface we want to put the device into. this
+ * parameter is only set if you want to use the callback to driver up/down the
+ * device
+ * @param req_info request parameters
+ *
+ * This is a wrapper for do_set_nl_link. If no handle is given, it opens a
+ * temporary one, sends down the requests and closes the handle again.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int set_link(struct can_handle *h, const char *name, int ifindex,
+		    __u8 if_state, struct req_info *req_info)
+{
+	int err;
+
+	if (check_link_id(name, ifindex) < 0)
+		return -1;
+
+	if (h != NULL)
+		return do_set_nl_link(h, if_state, name, ifindex, req_info);
+
+	h = tmp_handle_get();
+	if (h == NULL)
+		return -1;
+
+	err = do_set_nl_link(h, if_state, name, ifindex, req_info);
+	tmp_handle_put(h);
+
+	return err;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_do_start - can_do_start using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_do_start for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_do_start(struct can_handle *h, const char *name)
+{
+	return set_link(h, name, 0, IF_UP, NULL);
+}
+
+/**
+ * @ingroup extern
+ * can_do_start - start the can interface
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ *
+ * This starts the can interface with the given name. It simply changes the if
+ * state of the interface to up. All initialisation works will be done in
+ * kernel. The if state can also be queried by a simple ifconfig.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_do_start(const char *name)
+{
+	return can_handle_do_start(NULL, name);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_do_stop - can_do_stop using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_do_stop for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_do_stop(struct can_handle *h, const char *name)
+{
+	return set_link(h, name, 0, IF_DOWN, NULL);
+}
+
+/**
+ * @ingroup extern
+ * can_do_stop - stop the can interface
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ *
+ * This stops the can interface with the given name. It simply changes the if
+ * state of the interface to down. Any running communication would be stopped.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_do_stop(const char *name)
+{
+	return can_handle_do_stop(NULL, name);
+}
+
+/**
+ * @ingroup intern
+ * @brief link_do_restart - can_handle_do_restart by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_do_restart(struct can_handle *h, const char *name, int ifindex)
+{
+	int state;
+	__u32 restart_ms;
+
+	/* first we check if we can restart the device at all */
+	if ((get_link(h, name, ifindex, GET_STATE, &state)) < 0) {
+		fprintf(stderr, "cannot get bustate, "
+			"something is seriously wrong\n");
+		return -1;
+	} else if (state != CAN_STATE_BUS_OFF) {
+		fprintf(stderr,
+			"Device is not in BUS_OFF," " no use to restart\n");
+		return -1;
+	}
+
+	if ((get_link(h, name, ifindex, GET_RESTART_MS, &restart_ms)) < 0) {
+		fprintf(stderr, "cannot get restart_ms, "
+			"something is seriously wrong\n");
+		return -1;
+	} else if (restart_ms > 0) {
+		fprintf(stderr,
+			"auto restart with %ums interval is turned on,"
+			" no use to restart\n", restart_ms);
+		return -1;
+	}
+
+	struct req_info req_info = {
+		.restart = 1,
+	};
+
+	return set_link(h, name, ifindex, 0, &req_info);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_do_restart - can_do_restart using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_do_restart for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_do_restart(struct can_handle *h, const char *name)
+{
+	return link_do_restart(h, name, 0);
+}
+
+/**
+ * @ingroup extern
+ * can_do_restart - restart the can interface
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ *
+ * This triggers the start mode of the can device.
+ *
+ * NOTE:
+ * - restart mode can only be triggerd if the device is in BUS_OFF and the auto
+ * restart not turned on (restart_ms == 0)
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_do_restart(const char *name)
+{
+	struct can_handle *h;
+	int err;
+
+	h = tmp_handle_get();
+	if (h == NULL)
+		return -1;
+
+	err = can_handle_do_restart(h, name);
+	tmp_handle_put(h);
+
+	return err;
+}
+
+/**
+ * @ingroup intern
+ * @brief link_set_restart_ms - can_handle_set_restart_ms by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_set_restart_ms(struct can_handle *h, const char *name,
+		int ifindex, __u32 restart_ms)
+{
+	struct req_info req_info = {
+		.restart_ms = restart_ms,
+	};
+
+	if (restart_ms == 0)
+		req_info.disable_autorestart = 1;
+
+	return set_link(h, name, ifindex, 0, &req_info);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_restart_ms - can_set_restart_ms using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_set_restart_ms for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_restart_ms(struct can_handle *h, const char *name,
+		__u32 restart_ms)
+{
+	return link_set_restart_ms(h, name, 0, restart_ms);
+}
+
+/**
+ * @ingroup extern
+ * can_set_restart_ms - set interval of auto restart.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param restart_ms interval of auto restart in milliseconds
+ *
+ * This sets how often the device shall automatically restart the interface in
+ * case that a bus_off is detected.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_set_restart_ms(const char *name, __u32 restart_ms)
+{
+	return can_handle_set_restart_ms(NULL, name, restart_ms);
+}
+
+/**
+ * @ingroup intern
+ * @brief link_set_ctrlmode - can_handle_set_ctrlmode by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_set_ctrlmode(struct can_handle *h, const char *name,
+		int ifindex, struct can_ctrlmode *cm)
+{
+	struct req_info req_info = {
+		.ctrlmode = cm,
+	};
+
+	return set_link(h, name, ifindex, 0, &req_info);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_ctrlmode - can_set_ctrlmode using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_set_ctrlmode for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_ctrlmode(struct can_handle *h, const char *name,
+		struct can_ctrlmode *cm)
+{
+	return link_set_ctrlmode(h, name, 0, cm);
+}
+
+/**
+ * @ingroup extern
+ * can_set_ctrlmode - setup the control mode.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ *
+ * @param cm pointer of a can_ctrlmode struct
+ *
+ * This sets the control mode of the can device. There are currently the
+ * following modes available (each mapped to its own macro):
+ *
+ * @code
+ * #define CAN_CTRLMODE_LOOPBACK           0x01    // Loopback mode
+ * #define CAN_CTRLMODE_LISTENONLY         0x02    // Listen-only mode
+ * #define CAN_CTRLMODE_3_SAMPLES          0x04    // Triple sampling mode
+ * #define CAN_CTRLMODE_ONE_SHOT           0x08    // One-Shot mode
+ * #define CAN_CTRLMODE_BERR_REPORTING     0x10    // Bus-error reporting
+ * #define CAN_CTRLMODE_FD                 0x20    // CAN FD mode
+ * #define CAN_CTRLMODE_PRESUME_ACK        0x40    // Ignore missing CAN ACKs
+ * @endcode
+ *
+ * You have to define the control mode struct yourself. A can_ctrlmode struct
+ * is declared as:
+ *
+ * @code
+ * struct can_ctrlmode {
+ *	__u32 mask;
+ *	__u32 flags;
+ * }
+ * @endcode
+ *
+ * You can use mask to select modes you want to control and flags to determine
+ * if you want to turn the selected mode(s) on or off. E. g. the following
+ * pseudocode will turn the loopback mode on and listenonly mode off:
+ *
+ * @code
+ * struct can_ctrlmode cm;
+ * memset(&cm, 0, sizeof(cm));
+ * cm.mask = CAN_CTRLMODE_LOOPBACK | CAN_CTRLMODE_LISTENONLY;
+ * cm.flags = CAN_CTRLMODE_LOOPBACK;
+ * can_set_ctrlmode(candev, &cm);
+ * @endcode
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_set_ctrlmode(const char *name, struct can_ctrlmode *cm)
+{
+	return can_handle_set_ctrlmode(NULL, name, cm);
+}
+
+/**
+ * @ingroup intern
+ * @brief link_set_bittiming - can_handle_set_bittiming by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_set_bittiming(struct can_handle *h, const char *name,
+		int ifindex, struct can_bittiming *bt)
+{
+	struct req_info req_info = {
+		.bittiming = bt,
+	};
+
+	return set_link(h, name, ifindex, 0, &req_info);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_bittiming - can_set_bittiming using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_set_bittiming for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_bittiming(struct can_handle *h, const char *name,
+		struct can_bittiming *bt)
+{
+	return link_set_bittiming(h, name, 0, bt);
+}
+
+/**
+ * @ingroup extern
+ * can_set_bittiming - setup the bittiming.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param bt pointer to a can_bittiming struct
+ *
+ * This sets the bittiming of the can device. This is for advantage usage. In
+ * normal cases you should use can_set_bitrate to simply define the bitrate and
+ * let the driver automatically calculate the bittiming. You will only need this
+ * function if you wish to define the bittiming in expert mode with fully
+ * manually defined timing values.
+ * You have to define the bittiming struct yourself. a can_bittiming struct
+ * consists of:
+ *
+ * @code
+ * struct can_bittiming {
+ *	__u32 bitrate;
+ *	__u32 sample_point;
+ *	__u32 tq;
+ *	__u32 prop_seg;
+ *	__u32 phase_seg1;
+ *	__u32 phase_seg2;
+ *	__u32 sjw;
+ *	__u32 brp;
+ * }
+ * @endcode
+ *
+ * to define a customized bittiming, you have to define tq, prop_seq,
+ * phase_seg1, phase_seg2 and sjw. See http://www.can-cia.org/index.php?id=88
+ * for more information about bittiming and synchronizations on can bus.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_set_bittiming(const char *name, struct can_bittiming *bt)
+{
+	return can_handle_set_bittiming(NULL, name, bt);
+}
+
+/**
+ * @ingroup intern
+ * @brief link_set_canfd_bittiming - can_handle_set_canfd_bittiming by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_set_canfd_bittiming(struct can_handle *h, const char *name,
+		int ifindex, struct can_bittiming *bt,
+		struct can_bittiming *dbt)
+{
+	struct can_ctrlmode ctrl = {
+		.mask = CAN_CTRLMODE_FD,
+		.flags = CAN_CTRLMODE_FD,
+	};
+	struct req_info req_info = {
+		.bittiming = bt,
+		.dbittiming = dbt,
+		.ctrlmode = &ctrl
+	};
+
+	return set_link(h, name, ifindex, 0, &req_info);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_canfd_bittiming - can_set_canfd_bittiming using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_set_canfd_bittiming for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_canfd_bittiming(struct can_handle *h, const char *name,
+		struct can_bittiming *bt, struct can_bittiming *dbt)
+{
+	return link_set_canfd_bittiming(h, name, 0, bt, dbt);
+}
+
+/**
+ * @ingroup extern
+ * can_set_data_bittiming - setup the bittiming for CAN FD Data transmission.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param bt pointer to a can_bittiming struct
+ *
+ * This sets the bittiming of the can device for the data transmission if CAN FD is enabled. This is for advantage usage. In
+ * normal cases you should use can_set_bitrate to simply define the bitrate and
+ * let the driver automatically calculate the bittiming. You will only need this
+ * function if you wish to define the bittiming in expert mode with fully
+ * manually defined timing values.
+ * You have to define the bittiming struct yourself. a can_bittiming struct
+ * consists of:
+ *
+ * @code
+ * struct can_bittiming {
+ *	__u32 bitrate;
+ *	__u32 sample_point;
+ *	__u32 tq;
+ *	__u32 prop_seg;
+ *	__u32 phase_seg1;
+ *	__u32 phase_seg2;
+ *	__u32 sjw;
+ *	__u32 brp;
+ * }
+ * @endcode
+ *
+ * to define a customized bittiming, you have to define tq, prop_seq,
+ * phase_seg1, phase_seg2 and sjw. See http://www.can-cia.org/index.php?id=88
+ * for more information about bittiming and synchronizations on can bus.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_set_canfd_bittiming(const char *name, struct can_bittiming *bt, struct can_bittiming *dbt)
+{
+	return can_handle_set_canfd_bittiming(NULL, name, bt, dbt);
+}
+
+/**
+ * @ingroup intern
+ * @brief lookup_link_bittiming - look up precalculated bit timings for a link
+ *
+ * @param h netlink handle
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ * @param bitrate nominal bitrate
+ * @param sample_point nominal sample point
+ * @param dbitrate data bitrate, or 0 to look up the nominal phase only
+ * @param dsample_point data sample point
+ * @param bt pointer to store the nominal bit timing
+ * @param dbt pointer to store the data bit timing
+ *
+ * Takes the bit-timing constants and the clock of the link from the caps
+ * cache of the handle and looks them up with can_lookup_bittiming. Both
+ * phases have to use the same prescaler. Without the cache, reading them
+ * would cost a round trip more than letting the kernel calculate, so the
+ * table is not used then.
+ *
+ * @return 0 if the table has all bit timings
+ * @return 1 if not, or if the caps are not available
+ */
+static int lookup_link_bittiming(struct can_handle *h, const char *name,
+		int ifindex, __u32 bitrate, __u32 sample_point, __u32 dbitrate,
+		__u32 dsample_point, struct can_bittiming *bt,
+		struct can_bittiming *dbt)
+{
+	struct can_caps caps;
+
+	if (h == NULL || !h->caps_cache)
+		return 1;
+
+	/* let the kernel calculate rather than fail */
+	if (get_link(h, name, ifindex, GET_CAPS, &caps) < 0)
+		return 1;
+
+	if (!(caps.valid & CAN_CAPS_CLOCK) ||
+	    !(caps.valid & CAN_CAPS_BITTIMING_CONST) ||
+	    can_lookup_bittiming(&caps.bittiming_const, &caps.clock,
+				 bitrate, sample_point, bt) < 0)
+		return 1;
+
+	if (dbitrate == 0)
+		return 0;
+
+	if (!(caps.valid & CAN_CAPS_DATA_BITTIMING_CONST) ||
+	    can_lookup_bittiming(&caps.data_bittiming_const, &caps.clock,
+				 dbitrate, dsample_point, dbt) < 0 ||
+	    dbt->brp != bt->brp)
+		return 1;
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief link_set_bitrate - can_handle_set_bitrate by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_set_bitrate(struct can_handle *h, const char *name, int ifindex,
+		__u32 bitrate)
+{
+	struct can_bittiming bt;
+
+	memset(&bt, 0, sizeof(bt));
+	bt.bitrate = bitrate;
+
+	return link_set_bittiming(h, name, ifindex, &bt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_bitrate - can_set_bitrate using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_set_bitrate for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_bitrate(struct can_handle *h, const char *name, __u32 bitrate)
+{
+	return link_set_bitrate(h, name, 0, bitrate);
+}
+
+/**
+ * @ingroup extern
+ * can_set_bitrate - setup the bitrate.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param bitrate bitrate of the can bus
+ *
+ * This is the recommended way to setup the bus bit timing. You only have to
+ * give a bitrate value here. The exact bit timing will be calculated
+ * automatically. To use this function, make sure that CONFIG_CAN_CALC_BITTIMING
+ * is set to y in your kernel configuration. bitrate can be a value between
+ * 1000(1kbit/s) and 1000000(1000kbit/s).
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_set_bitrate(const char *name, __u32 bitrate)
+{
+	return can_handle_set_bitrate(NULL, name, bitrate);
+}
+
+/**
+ * @ingroup intern
+ * @brief link_set_bitrate_samplepoint - can_handle_set_bitrate_samplepoint by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_set_bitrate_samplepoint(struct can_handle *h, const char *name,
+		int ifindex, __u32 bitrate, __u32 sample_point)
+{
+	struct can_bittiming bt;
+
+	if (lookup_link_bittiming(h, name, ifindex, bitrate, sample_point,
+				  0, 0, &bt, NULL) != 0) {
+		memset(&bt, 0, sizeof(bt));
+		bt.bitrate = bitrate;
+		bt.sample_point = sample_point;
+	}
+
+	return link_set_bittiming(h, name, ifindex, &bt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_bitrate_samplepoint - can_set_bitrate_samplepoint using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_set_bitrate_samplepoint for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_bitrate_samplepoint(struct can_handle *h, const char *name,
+		__u32 bitrate, __u32 sample_point)
+{
+	return link_set_bitrate_samplepoint(h, name, 0, bitrate, sample_point);
+}
+
+/**
+ * @ingroup extern
+ * can_set_bitrate_samplepoint - setup the bitrate.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param bitrate bitrate of the can bus
+ * @param sample_point sample point value
+ *
+ * This one is similar to can_set_bitrate, only you can additionally set up the
+ * time point for sampling (sample point) customly instead of using the
+ * CIA recommended value. sample_point can be a value between 0 and 999.
+ *
+ * With a handle whose caps cache is enabled, see
+ * can_handle_set_bitrate_samplepoint and can_handle_caps_cache: if the
+ * controller, its clock and the bitrate are found in the table of
+ * can_lookup_bittiming, the fully specified bit timing from the table is sent
+ * and the kernel does not calculate anything. Otherwise the kernel calculates
+ * the bit timing as before.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_set_bitrate_samplepoint(const char *name, __u32 bitrate,
+				__u32 sample_point)
+{
+	return can_handle_set_bitrate_samplepoint(NULL, name, bitrate, sample_point);
+}
+
+/**
+ * @ingroup intern
+ * @brief link_set_canfd_bitrates_samplepoint - can_handle_set_canfd_bitrates_samplepoint by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_set_canfd_bitrates_samplepoint(struct can_handle *h,
+		const char *name, int ifindex, __u32 bitrate,
+		__u32 sample_point, __u32 dbitrate, __u32 dsample_point)
+{
+	struct can_bittiming bt;
+	struct can_bittiming dbt;
+
+	if (lookup_link_bittiming(h, name, ifindex, bitrate, sample_point,
+				  dbitrate, dsample_point, &bt, &dbt) != 0) {
+		memset(&bt, 0, sizeof(bt));
+		bt.bitrate = bitrate;
+		bt.sample_point = sample_point;
+
+		memset(&dbt, 0, sizeof(dbt));
+		dbt.bitrate = dbitrate;
+		dbt.sample_point = dsample_point;
+	}
+
+	return link_set_canfd_bittiming(h, name, ifindex, &bt, &dbt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_canfd_bitrates_samplepoint - can_set_canfd_bitrates_samplepoint using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_set_canfd_bitrates_samplepoint for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_canfd_bitrates_samplepoint(struct can_handle *h,
+		const char *name, __u32 bitrate, __u32 sample_point, __u32 dbitrate,
+		__u32 dsample_point)
+{
+	return link_set_canfd_bitrates_samplepoint(h, name, 0, bitrate,
+			sample_point, dbitrate, dsample_point);
+}
+
+/**
+ * @ingroup extern
+ * can_set_canfd_bitrates_samplepoint - setup the bitrate.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param bitrate bitrate of the can bus
+ * @param sample_point sample point value
+ * @param dbitrate dbitrate of the can bus
+ * @param dsample_point dsample point value
+ *
+ * This one is similar to can_set_bitrate, only you can additionally set up the
+ * time point for sampling (sample point) customly instead of using the
+ * CIA recommended value. sample_point can be a value between 0 and 999.
+ *
+ * With a handle whose caps cache is enabled, the table of
+ * can_lookup_bittiming is used if it has entries for both phases with the
+ * same prescaler. Otherwise the kernel calculates the bit timing as before.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_set_canfd_bitrates_samplepoint(const char *name, __u32 bitrate,
+				__u32 sample_point, __u32 dbitrate, __u32 dsample_point)
+{
+	return can_handle_set_canfd_bitrates_samplepoint(NULL, name, bitrate, sample_point, dbitrate, dsample_point);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_state - can_get_state using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_state for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_state(struct can_handle *h, const char *name, int *state)
+{
+	return get_link(h, name, 0, GET_STATE, state);
+}
+
+/**
+ * @ingroup extern
+ * can_get_state - get the current state of the device
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param state pointer to store the state
+ *
+ * This one stores the current state of the can interface into the given
+ * pointer. Valid states are:
+ * - CAN_STATE_ERROR_ACTIVE
+ * - CAN_STATE_ERROR_WARNING
+ * - CAN_STATE_ERROR_PASSIVE
+ * - CAN_STATE_BUS_OFF
+ * - CAN_STATE_STOPPED
+ * - CAN_STATE_SLEEPING
+ *
+ * The first four states is determined by the value of RX/TX error counter.
+ * Please see relevant can specification for more information about this. A
+ * device in STATE_STOPPED is an inactive device. STATE_SLEEPING is not
+ * implemented on all devices.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_state(const char *name, int *state)
+{
+	return can_handle_get_state(NULL, name, state);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_restart_ms - can_get_restart_ms using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_restart_ms for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_restart_ms(struct can_handle *h, const char *name,
+		__u32 *restart_ms)
+{
+	return get_link(h, name, 0, GET_RESTART_MS, restart_ms);
+}
+
+/**
+ * @ingroup extern
+ * can_get_restart_ms - get the current interval of auto restarting.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param restart_ms pointer to store the value.
+ *
+ * This one stores the current interval of auto restarting into the given
+ * pointer.
+ *
+ * The socketcan framework can automatically restart a device if it is in
+ * bus_off in a given interval. This function gets this value in milliseconds.
+ * restart_ms == 0 means that autorestarting is turned off.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_restart_ms(const char *name, __u32 *restart_ms)
+{
+	return can_handle_get_restart_ms(NULL, name, restart_ms);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_bittiming - can_get_bittiming using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_bittiming for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_bittiming(struct can_handle *h, const char *name,
+		struct can_bittiming *bt)
+{
+	return get_link(h, name, 0, GET_BITTIMING, bt);
+}
+
+/**
+ * @ingroup extern
+ * can_get_bittiming - get the current bittimnig configuration.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param bt pointer to the bittiming struct.
+ *
+ * This one stores the current bittiming configuration.
+ *
+ * Please see can_set_bittiming for more information about bit timing.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_bittiming(const char *name, struct can_bittiming *bt)
+{
+	return can_handle_get_bittiming(NULL, name, bt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_data_bittiming - can_get_data_bittiming using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_data_bittiming for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_data_bittiming(struct can_handle *h, const char *name,
+		struct can_bittiming *dbt)
+{
+	return get_link(h, name, 0, GET_DATA_BITTIMING, dbt);
+}
+
+/**
+ * @ingroup extern
+ * can_get_data_bittiming - get the current bittimnig configuration.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param dbt pointer to the bittiming struct.
+ *
+ * This one stores the current bittiming configuration.
+ *
+ * Please see can_set_bittiming for more information about bit timing.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_data_bittiming(const char *name, struct can_bittiming *dbt)
+{
+	return can_handle_get_data_bittiming(NULL, name, dbt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_ctrlmode - can_get_ctrlmode using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_ctrlmode for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_ctrlmode(struct can_handle *h, const char *name,
+		struct can_ctrlmode *cm)
+{
+	return get_link(h, name, 0, GET_CTRLMODE, cm);
+}
+
+/**
+ * @ingroup extern
+ * can_get_ctrlmode - get the current control mode.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param cm pointer to the ctrlmode struct.
+ *
+ * This one stores the current control mode configuration.
+ *
+ * Please see can_set_ctrlmode for more information about control modes.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_ctrlmode(const char *name, struct can_ctrlmode *cm)
+{
+	return can_handle_get_ctrlmode(NULL, name, cm);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_clock - can_get_clock using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_clock for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_clock(struct can_handle *h, const char *name,
+		struct can_clock *clock)
+{
+	return get_link(h, name, 0, GET_CLOCK, clock);
+}
+
+/**
+ * @ingroup extern
+ * can_get_clock - get the current clock struct.
+ *
+ * @param name: name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param clock pointer to the clock struct.
+ *
+ * This one stores the current clock configuration. At the time of writing the
+ * can_clock struct only contains information about the clock frequecy. This
+ * information is e.g. essential while setting up the bit timing.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_clock(const char *name, struct can_clock *clock)
+{
+	return can_handle_get_clock(NULL, name, clock);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_bittiming_const - can_get_bittiming_const using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_bittiming_const for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_bittiming_const(struct can_handle *h, const char *name,
+		struct can_bittiming_const *btc)
+{
+	return get_link(h, name, 0, GET_BITTIMING_CONST, btc);
+}
+
+/**
+ * @ingroup extern
+ * can_get_bittiming_const - get the current bittimnig constant.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param btc pointer to the bittiming constant struct.
+ *
+ * This one stores the hardware dependent bittiming constant. The
+ * can_bittiming_const struct consists:
+ *
+ * @code
+ * struct can_bittiming_const {
+ *	char name[16];
+ *	__u32 tseg1_min;
+ *	__u32 tseg1_max;
+ *	__u32 tseg2_min;
+ *	__u32 tseg2_max;
+ *	__u32 sjw_max;
+ *	__u32 brp_min;
+ *	__u32 brp_max;
+ *	__u32 brp_inc;
+ *	};
+ * @endcode
+ *
+ * The information in this struct is used to calculate the bus bit timing
+ * automatically.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_bittiming_const(const char *name, struct can_bittiming_const *btc)
+{
+	return can_handle_get_bittiming_const(NULL, name, btc);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_data_bittiming_const - can_get_data_bittiming_const using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_data_bittiming_const for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_data_bittiming_const(struct can_handle *h, const char *name,
+		struct can_bittiming_const *dbtc)
+{
+	return get_link(h, name, 0, GET_DATA_BITTIMING_CONST, dbtc);
+}
+
+/**
+ * @ingroup extern
+ * can_get_data_bittiming_const - get the current bittimnig constant.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param dbtc pointer to the bittiming constant struct.
+ *
+ * This one stores the hardware dependent bittiming constant. The
+ * can_bittiming_const struct consists:
+ *
+ * @code
+ * struct can_bittiming_const {
+ *	char name[16];
+ *	__u32 tseg1_min;
+ *	__u32 tseg1_max;
+ *	__u32 tseg2_min;
+ *	__u32 tseg2_max;
+ *	__u32 sjw_max;
+ *	__u32 brp_min;
+ *	__u32 brp_max;
+ *	__u32 brp_inc;
+ *	};
+ * @endcode
+ *
+ * The information in this struct is used to calculate the bus bit timing
+ * automatically.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_data_bittiming_const(const char *name, struct can_bittiming_const *dbtc)
+{
+	return can_handle_get_data_bittiming_const(NULL, name, dbtc);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_berr_counter - can_get_berr_counter using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_berr_counter for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_berr_counter(struct can_handle *h, const char *name,
+		struct can_berr_counter *bc)
+{
+	return get_link(h, name, 0, GET_BERR_COUNTER, bc);
+}
+
+/**
+ * @ingroup extern
+ * can_get_berr_counter - get the tx/rx error counter.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param bc pointer to the error counter struct..
+ *
+ * This one gets the current rx/tx error counter from the hardware.
+ *
+ * @code
+ * struct can_berr_counter {
+ *	__u16 txerr;
+ *	__u16 rxerr;
+ *	};
+ * @endcode
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_berr_counter(const char *name, struct can_berr_counter *bc)
+{
+	return can_handle_get_berr_counter(NULL, name, bc);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_device_stats - can_get_device_stats using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_device_stats for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_device_stats(struct can_handle *h, const char *name,
+		struct can_device_stats *cds)
+{
+	return get_link(h, name, 0, GET_XSTATS, cds);
+}
+
+/**
+ * @ingroup extern
+ * can_get_device_stats - get the can_device_stats.
+ *
+ * @param name name of the can device. This is the netdev name, as ifconfig -a shows
+ * in your system. usually it contains prefix "can" and the numer of the can
+ * line. e.g. "can0"
+ * @param bc pointer to the error counter struct..
+ *
+ * This one gets the current can_device_stats.
+ *
+ * Please see struct can_device_stats for more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_device_stats(const char *name, struct can_device_stats *cds)
+{
+	return can_handle_get_device_stats(NULL, name, cds);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_link_stats - can_get_link_stats using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_link_stats for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_link_stats(struct can_handle *h, const char *name,
+		struct rtnl_link_stats64 *rls)
+{
+	return get_link(h, name, 0, GET_LINK_STATS, rls);
+}
+
+/**
+ * @ingroup extern
+ * can_get_link_statistics - get RX/TX statistics (64 bits version)
+ *
+ * @param name name of the can device. This is the netdev name, as ip link shows
+ * in your system. usually it contains prefix "can" and the number of the can
+ * line. e.g. "can0"
+ * @param rls pointer to the rtnl_link_stats64 struct which is from if_link.h.
+ *
+ * This one gets the current rtnl_link_stats64. Compares to the rtnl_link_stats,
+ * The rtnl_link_stats64 is introduced since linux kernel 2.6. After that the
+ * rtnl_link_stats is synchronous with struct rtnl_link_stats64 by truncating
+ * each member from 64 bits to 32 bits. actually, the struct rtnl_link_stats
+ * is kept for compatibility.
+ *
+ * The statistics are read with a RTM_GETSTATS request if the kernel supports
+ * it, see can_get_stats.
+ *
+ * Please see struct rtnl_link_stats64 (/usr/include/linux/if_link.h) for more
+ * information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_link_stats(const char *name, struct rtnl_link_stats64 *rls)
+{
+	return can_handle_get_link_stats(NULL, name, rls);
+}
+
+/**
+ * @ingroup intern
+ * @brief link_get_stats - can_handle_get_stats by name or index
+ *
+ * @param name name of the can device, or NULL
+ * @param ifindex interface index, used if name is NULL
+ */
+static int link_get_stats(struct can_handle *h, const char *name, int ifindex,
+		struct rtnl_link_stats64 *rls, struct can_device_stats *cds)
+{
+	struct can_link_info info;
+
+	if (cds == NULL)
+		return get_link(h, name, ifindex, GET_LINK_STATS, rls);
+
+	if (get_link(h, name, ifindex, GET_LINK_INFO, &info) < 0)
+		return -1;
+
+	if (get_link_field(&info, GET_XSTATS, cds) < 0)
+		return -1;
+
+	if (rls != NULL && get_link_field(&info, GET_LINK_STATS, rls) < 0)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_stats - can_get_stats using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_stats for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_stats(struct can_handle *h, const char *name,
+		struct rtnl_link_stats64 *rls, struct can_device_stats *cds)
+{
+	return link_get_stats(h, name, 0, rls, cds);
+}
+
+/**
+ * @ingroup extern
+ * can_get_stats - get the link and the can device statistics at once
+ *
+ * @param name name of the can device. This is the netdev name, as ip link shows
+ * in your system. usually it contains prefix "can" and the number of the can
+ * line. e.g. "can0"
+ * @param rls pointer to the rtnl_link_stats64 struct, or NULL
+ * @param cds pointer to the can_device_stats struct, or NULL
+ *
+ * This one is meant for polling the counters. The link statistics alone are
+ * read with a RTM_GETSTATS request, whose reply carries only the counters
+ * instead of every attribute of the link. Kernels without RTM_GETSTATS
+ * (before 4.7) are detected once per handle, the RTM_GETLINK path is used
+ * for them instead. can_get_link_stats does the same. RTM_GETSTATS needs the
+ * interface index, so a link addressed by name is only read that way with
+ * the name cache of the handle enabled, see can_handle_name_cache.
+ *
+ * The can device statistics are only reported as IFLA_INFO_XSTATS in a
+ * RTM_GETLINK reply, the CAN drivers do not fill IFLA_STATS_LINK_XSTATS. If
+ * cds is given, both structs are therefore taken from a single RTM_GETLINK
+ * reply.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_stats(const char *name, struct rtnl_link_stats64 *rls,
+		  struct can_device_stats *cds)
+{
+	return can_handle_get_stats(NULL, name, rls, cds);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_link_info - can_get_link_info using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_link_info for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_link_info(struct can_handle *h, const char *name,
+		struct can_link_info *info)
+{
+	return get_link(h, name, 0, GET_LINK_INFO, info);
+}
+
+/**
+ * @ingroup extern
+ * can_get_link_info - get a snapshot of all link attributes at once
+ *
+ * @param name name of the can device. This is the netdev name, as ip link shows
+ * in your system. usually it contains prefix "can" and the number of the can
+ * line. e.g. "can0"
+ * @param info pointer to the can_link_info struct.
+ *
+ * This one fills the state, restart_ms, bittiming, ctrlmode, clock, bittiming
+ * constants, error counters, can_device_stats and rtnl_link_stats64 from a
+ * single netlink reply, where calling the individual getters would need one
+ * round trip each.
+ *
+ * Attributes the driver did not send are zeroed. Check the CAN_LINK_INFO_*
+ * bits in info->valid to see which members have been filled, e.g.:
+ *
+ * @code
+ * struct can_link_info info;
+ *
+ * if (can_get_link_info("can0", &info) == 0 &&
+ *     (info.valid & CAN_LINK_INFO_BERR_COUNTER))
+ *	printf("txerr %u\n", info.berr_counter.txerr);
+ * @endcode
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_link_info(const char *name, struct can_link_info *info)
+{
+	return can_handle_get_link_info(NULL, name, info);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_caps - can_get_caps using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * With the capability cache of the handle enabled, see can_handle_caps_cache,
+ * only the first call for a device asks the kernel.
+ *
+ * Please see can_get_caps for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_caps(struct can_handle *h, const char *name,
+		struct can_caps *caps)
+{
+	return get_link(h, name, 0, GET_CAPS, caps);
+}
+
+/**
+ * @ingroup extern
+ * can_get_caps - get the static capabilities of a can controller
+ *
+ * @param name name of the can device. This is the netdev name, as ip link shows
+ * in your system. usually it contains prefix "can" and the number of the can
+ * line. e.g. "can0"
+ * @param caps pointer to the can_caps struct.
+ *
+ * This one fills the clock, the bittiming constants of both phases and the
+ * ctrlmode flags the controller supports. These never change for the life of
+ * a net device. Check the CAN_CAPS_* bits in caps->valid to see which members
+ * the driver reported. ctrlmode_supported needs Linux 5.15 or later.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_get_caps(const char *name, struct can_caps *caps)
+{
+	return can_handle_get_caps(NULL, name, caps);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_name_cache - enable or disable the name cache of a handle
+ *
+ * @param h netlink handle as returned by can_handle_open
+ * @param enable 1 to enable the cache, 0 to disable it
+ *
+ * The name cache maps the names of all can interfaces to their interface
+ * indexes, so that can_handle_name_to_index does not need a netlink round
+ * trip. It is filled with one link dump when enabled, and the handle joins
+ * the RTNLGRP_LINK group to keep it current: RTM_NEWLINK notifications add or
+ * rename entries, RTM_DELLINK notifications remove them, so a renamed or
+ * unplugged interface is not reported with its old index.
+ *
+ * Notifications are applied whenever the handle reads from its socket, i.e.
+ * during every request sent on it and in can_handle_dispatch. A handle that
+ * is idle for a while should therefore be polled with can_handle_fd and
+ * can_handle_dispatch. If notifications were lost because the socket receive
+ * buffer overflowed, the cache is refilled with the next lookup.
+ *
+ * The cache can not be enabled while query coalescing is, see
+ * can_handle_coalesce.
+ *
+ * @return 0 if success
+ * @return -1 if failed, errno is set to EBUSY if query coalescing is enabled
+ */
+int can_handle_name_cache(struct can_handle *h, int enable)
+{
+	if (!enable) {
+		if (h->name_cache) {
+			handle_subscribe(h, 0);
+			h->name_cache = 0;
+			h->nnames = 0;
+		}
+		return 0;
+	}
+
+	if (h->name_cache)
+		return 0;
+
+	if (h->coalesce) {
+		fprintf(stderr, "Cannot enable a cache with query coalescing\n");
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (handle_subscribe(h, 1) < 0)
+		return -1;
+
+	h->name_cache = 1;
+	if (name_cache_resync(h) < 0) {
+		handle_subscribe(h, 0);
+		h->name_cache = 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_name_to_index - get the interface index of a can device
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param name name of the can device. This is the netdev name, as ip link shows
+ * in your system. usually it contains prefix "can" and the number of the can
+ * line. e.g. "can0"
+ *
+ * With the name cache of the handle enabled, see can_handle_name_cache, this
+ * is a lookup in memory after applying the notifications queued on the
+ * socket, which costs a non-blocking read but no round trip. Like
+ * can_handle_dispatch, that read also completes pending async requests.
+ * Otherwise the index is queried from the kernel.
+ *
+ * The index can be passed to the can_handle_*_by_index functions.
+ *
+ * @return interface index if success
+ * @return -1 if failed, errno is set to ENODEV if the device does not exist
+ */
+int can_handle_name_to_index(struct can_handle *h, const char *name)
+{
+	int ifindex;
+	int i;
+
+	if (h == NULL || !h->name_cache) {
+		if (get_link(h, name, 0, GET_IFINDEX, &ifindex) < 0)
+			return -1;
+		return ifindex;
+	}
+
+	/* a rename or unplug may still be queued */
+	if (can_handle_dispatch(h) < 0)
+		return -1;
+
+	if (h->names_stale && name_cache_resync(h) < 0)
+		return -1;
+
+	for (i = 0; i < h->nnames; i++)
+		if (strcmp(h->names[i].name, name) == 0)
+			return h->names[i].ifindex;
+
+	fprintf(stderr, "Cannot find device \"%s\"\n", name);
+	errno = ENODEV;
+
+	return -1;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_caps_cache - enable or disable the capability cache of a handle
+ *
+ * @param h netlink handle as returned by can_handle_open
+ * @param enable 1 to enable the cache, 0 to disable it
+ *
+ * The capability cache keeps the static parameters of the can interfaces per
+ * interface index: the clock, the bittiming constants of both phases and the
+ * supported ctrlmode flags. With the cache enabled, can_handle_get_caps,
+ * can_handle_get_clock, can_handle_get_bittiming_const,
+ * can_handle_get_data_bittiming_const and their _by_index variants read them
+ * from memory, without any system call. can_handle_set_bitrate_samplepoint
+ * and can_handle_set_canfd_bitrates_samplepoint only look up the table of
+ * can_lookup_bittiming with the cache enabled, and send the bit timing from
+ * the table then.
+ *
+ * The cache is filled with one link dump when enabled, devices which show up
+ * later are added by their first lookup. The handle joins the RTNLGRP_LINK
+ * group: a RTM_DELLINK notification drops the entry of the device, a
+ * RTM_NEWLINK notification replaces it, so neither a removed nor a newly
+ * registered device is served stale capabilities. Notifications are applied
+ * whenever the handle reads from its socket, see can_handle_name_cache. If
+ * the socket overran and notifications were lost, which any read on the
+ * handle notices, the cache is emptied and refilled on demand.
+ *
+ * The cache can not be enabled while query coalescing is, see
+ * can_handle_coalesce.
+ *
+ * @return 0 if success
+ * @return -1 if failed, errno is set to EBUSY if query coalescing is enabled
+ */
+int can_handle_caps_cache(struct can_handle *h, int enable)
+{
+	if (!enable) {
+		if (h->caps_cache) {
+			handle_subscribe(h, 0);
+			h->caps_cache = 0;
+			h->ncaps = 0;
+		}
+		return 0;
+	}
+
+	if (h->caps_cache)
+		return 0;
+
+	if (h->coalesce) {
+		fprintf(stderr, "Cannot enable a cache with query coalescing\n");
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (handle_subscribe(h, 1) < 0)
+		return -1;
+
+	h->caps_cache = 1;
+	h->ncaps = 0;
+	if (do_walk_nl_link(h, NULL, 0, caps_cache_fill, h,
+			    RTEXT_FILTER_SKIP_STATS) < 0) {
+		handle_subscribe(h, 0);
+		h->caps_cache = 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_coalesce - enable or disable query coalescing on a handle
+ *
+ * @param h netlink handle as returned by can_handle_open
+ * @param enable 1 to enable coalescing, 0 to disable it
+ * @param window_us freshness window in microseconds, e.g. 1000
+ *
+ * With coalescing enabled, the getters of the handle may be called from
+ * several threads at once and share their netlink round trips: a caller
+ * asking for a link which is being queried by another thread waits for that
+ * reply instead of sending its own request, and a caller arriving within
+ * window_us after a query of the link completed gets its result right away.
+ * Links are told apart as they are addressed, by name or by index. Every
+ * modification request sent on the handle invalidates the results, so a
+ * getter never reports the state from before a setter on the same handle.
+ *
+ * This covers the getters of single parameters, e.g. can_handle_get_state
+ * and can_handle_get_berr_counter, can_handle_get_link_info, the statistics
+ * getters and their _by_index variants. All other functions must still not
+ * be called on the handle from more than one thread at a time, and
+ * coalescing must not be switched while other threads use the handle. The
+ * name and capability caches update themselves from the socket without
+ * locking, so coalescing can not be enabled together with either of them.
+ * See can_handle_get_coalesce_stats for the counters.
+ *
+ * @return 0 if success
+ * @return -1 if failed, errno is set to EBUSY if the name or the capability
+ * cache of the handle is enabled, ENOSYS if the library was built without
+ * thread support
+ */
+int can_handle_coalesce(struct can_handle *h, int enable, __u32 window_us)
+{
+#ifdef HAVE_PTHREAD
+	struct snapshot *s;
+
+	if (!enable) {
+		if (!h->coalesce)
+			return 0;
+
+		while ((s = h->snapshots) != NULL) {
+			h->snapshots = s->next;
+			free(s);
+		}
+		pthread_mutex_destroy(&h->coalesce_lock);
+		pthread_cond_destroy(&h->coalesce_cond);
+		pthread_mutex_destroy(&h->io_lock);
+		h->coalesce = 0;
+		return 0;
+	}
+
+	if (h->name_cache || h->caps_cache) {
+		fprintf(stderr, "Cannot coalesce queries with a cache enabled\n");
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (!h->coalesce) {
+		if (pthread_mutex_init(&h->coalesce_lock, NULL) != 0 ||
+		    pthread_cond_init(&h->coalesce_cond, NULL) != 0 ||
+		    pthread_mutex_init(&h->io_lock, NULL) != 0) {
+			fprintf(stderr, "Cannot set up query coalescing\n");
+			return -1;
+		}
+		memset(&h->coalesce_stats, 0, sizeof(h->coalesce_stats));
+		h->coalesce = 1;
+	}
+	h->coalesce_window_us = window_us;
+
+	return 0;
+#else
+	if (!enable)
+		return 0;
+
+	fprintf(stderr, "Query coalescing needs thread support\n");
+	errno = ENOSYS;
+
+	return -1;
+#endif
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_coalesce_stats - get the query coalescing counters of a handle
+ *
+ * @param h netlink handle as returned by can_handle_open
+ * @param stats pointer to the can_coalesce_stats struct.
+ *
+ * queries counts the netlink round trips of coalesced getters,
+ * merged_in_flight the calls which waited for a running query and
+ * merged_fresh the calls served from a result within the freshness window.
+ * The counters start at 0 when coalescing is enabled.
+ *
+ * @return 0 if success
+ * @return -1 if coalescing is not enabled
+ */
+int can_handle_get_coalesce_stats(struct can_handle *h,
+		struct can_coalesce_stats *stats)
+{
+	if (!h->coalesce) {
+		fprintf(stderr, "Query coalescing is not enabled\n");
+		errno = EINVAL;
+		return -1;
+	}
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&h->coalesce_lock);
+#endif
+	memcpy(stats, &h->coalesce_stats, sizeof(*stats));
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&h->coalesce_lock);
+#endif
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_do_start_by_index - can_handle_do_start addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_do_start for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_do_start_by_index(struct can_handle *h, int ifindex)
+{
+	return set_link(h, NULL, ifindex, IF_UP, NULL);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_do_stop_by_index - can_handle_do_stop addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_do_stop for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_do_stop_by_index(struct can_handle *h, int ifindex)
+{
+	return set_link(h, NULL, ifindex, IF_DOWN, NULL);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_do_restart_by_index - can_handle_do_restart addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_do_restart for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_do_restart_by_index(struct can_handle *h, int ifindex)
+{
+	return link_do_restart(h, NULL, ifindex);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_restart_ms_by_index - can_handle_set_restart_ms addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_set_restart_ms for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_restart_ms_by_index(struct can_handle *h, int ifindex,
+		__u32 restart_ms)
+{
+	return link_set_restart_ms(h, NULL, ifindex, restart_ms);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_ctrlmode_by_index - can_handle_set_ctrlmode addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_set_ctrlmode for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_ctrlmode_by_index(struct can_handle *h, int ifindex,
+		struct can_ctrlmode *cm)
+{
+	return link_set_ctrlmode(h, NULL, ifindex, cm);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_bittiming_by_index - can_handle_set_bittiming addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_set_bittiming for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_bittiming_by_index(struct can_handle *h, int ifindex,
+		struct can_bittiming *bt)
+{
+	return link_set_bittiming(h, NULL, ifindex, bt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_canfd_bittiming_by_index - can_handle_set_canfd_bittiming addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_set_canfd_bittiming for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_canfd_bittiming_by_index(struct can_handle *h, int ifindex,
+		struct can_bittiming *bt, struct can_bittiming *dbt)
+{
+	return link_set_canfd_bittiming(h, NULL, ifindex, bt, dbt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_bitrate_by_index - can_handle_set_bitrate addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_set_bitrate for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_bitrate_by_index(struct can_handle *h, int ifindex,
+		__u32 bitrate)
+{
+	return link_set_bitrate(h, NULL, ifindex, bitrate);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_bitrate_samplepoint_by_index - can_handle_set_bitrate_samplepoint addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_set_bitrate_samplepoint for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_bitrate_samplepoint_by_index(struct can_handle *h,
+		int ifindex, __u32 bitrate, __u32 sample_point)
+{
+	return link_set_bitrate_samplepoint(h, NULL, ifindex, bitrate, sample_point);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_set_canfd_bitrates_samplepoint_by_index - can_handle_set_canfd_bitrates_samplepoint addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_set_canfd_bitrates_samplepoint for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_set_canfd_bitrates_samplepoint_by_index(struct can_handle *h,
+		int ifindex, __u32 bitrate, __u32 sample_point, __u32 dbitrate,
+		__u32 dsample_point)
+{
+	return link_set_canfd_bitrates_samplepoint(h, NULL, ifindex, bitrate,
+			sample_point, dbitrate, dsample_point);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_stats_by_index - can_handle_get_stats addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_stats for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_stats_by_index(struct can_handle *h, int ifindex,
+		struct rtnl_link_stats64 *rls, struct can_device_stats *cds)
+{
+	return link_get_stats(h, NULL, ifindex, rls, cds);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_state_by_index - can_handle_get_state addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_state for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_state_by_index(struct can_handle *h, int ifindex, int *state)
+{
+	return get_link(h, NULL, ifindex, GET_STATE, state);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_restart_ms_by_index - can_handle_get_restart_ms addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_restart_ms for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_restart_ms_by_index(struct can_handle *h, int ifindex,
+		__u32 *restart_ms)
+{
+	return get_link(h, NULL, ifindex, GET_RESTART_MS, restart_ms);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_bittiming_by_index - can_handle_get_bittiming addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_bittiming for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_bittiming_by_index(struct can_handle *h, int ifindex,
+		struct can_bittiming *bt)
+{
+	return get_link(h, NULL, ifindex, GET_BITTIMING, bt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_data_bittiming_by_index - can_handle_get_data_bittiming addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_data_bittiming for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_data_bittiming_by_index(struct can_handle *h, int ifindex,
+		struct can_bittiming *dbt)
+{
+	return get_link(h, NULL, ifindex, GET_DATA_BITTIMING, dbt);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_ctrlmode_by_index - can_handle_get_ctrlmode addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_ctrlmode for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_ctrlmode_by_index(struct can_handle *h, int ifindex,
+		struct can_ctrlmode *cm)
+{
+	return get_link(h, NULL, ifindex, GET_CTRLMODE, cm);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_clock_by_index - can_handle_get_clock addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_clock for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_clock_by_index(struct can_handle *h, int ifindex,
+		struct can_clock *clock)
+{
+	return get_link(h, NULL, ifindex, GET_CLOCK, clock);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_bittiming_const_by_index - can_handle_get_bittiming_const addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_bittiming_const for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_bittiming_const_by_index(struct can_handle *h, int ifindex,
+		struct can_bittiming_const *btc)
+{
+	return get_link(h, NULL, ifindex, GET_BITTIMING_CONST, btc);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_data_bittiming_const_by_index - can_handle_get_data_bittiming_const addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_data_bittiming_const for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_data_bittiming_const_by_index(struct can_handle *h,
+		int ifindex, struct can_bittiming_const *dbtc)
+{
+	return get_link(h, NULL, ifindex, GET_DATA_BITTIMING_CONST, dbtc);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_berr_counter_by_index - can_handle_get_berr_counter addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_berr_counter for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_berr_counter_by_index(struct can_handle *h, int ifindex,
+		struct can_berr_counter *bc)
+{
+	return get_link(h, NULL, ifindex, GET_BERR_COUNTER, bc);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_device_stats_by_index - can_handle_get_device_stats addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_device_stats for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_device_stats_by_index(struct can_handle *h, int ifindex,
+		struct can_device_stats *cds)
+{
+	return get_link(h, NULL, ifindex, GET_XSTATS, cds);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_link_stats_by_index - can_handle_get_link_stats addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_link_stats for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_link_stats_by_index(struct can_handle *h, int ifindex,
+		struct rtnl_link_stats64 *rls)
+{
+	return get_link(h, NULL, ifindex, GET_LINK_STATS, rls);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_link_info_by_index - can_handle_get_link_info addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_link_info for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_link_info_by_index(struct can_handle *h, int ifindex,
+		struct can_link_info *info)
+{
+	return get_link(h, NULL, ifindex, GET_LINK_INFO, info);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_caps_by_index - can_handle_get_caps addressing the device by index
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param ifindex interface index of the can device
+ *
+ * Please see can_get_caps for the other parameters and more information.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_handle_get_caps_by_index(struct can_handle *h, int ifindex,
+		struct can_caps *caps)
+{
+	return get_link(h, NULL, ifindex, GET_CAPS, caps);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_foreach_link - can_foreach_link using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_foreach_link for the other parameters and more information.
+ *
+ * @return number of can interfaces reported if success
+ * @return -1 if failed
+ */
+int can_handle_foreach_link(struct can_handle *h, can_link_info_cb cb,
+		void *data)
+{
+	int ret;
+
+	if (h != NULL)
+		return do_walk_nl_link(h, NULL, 0, cb, data, 0);
+
+	h = tmp_handle_get();
+	if (h == NULL)
+		return -1;
+
+	ret = do_walk_nl_link(h, NULL, 0, cb, data, 0);
+	tmp_handle_put(h);
+
+	return ret;
+}
+
+/**
+ * @ingroup extern
+ * can_foreach_link - enumerate all can interfaces
+ *
+ * @param cb callback invoked for every can interface
+ * @param data user pointer passed to cb
+ *
+ * This one walks a single netlink dump of all interfaces and calls cb with a
+ * snapshot (see can_get_link_info) of every interface of kind "can". If cb
+ * returns non-zero, the enumeration stops.
+ *
+ * @return number of can interfaces reported if success
+ * @return -1 if failed
+ */
+int can_foreach_link(can_link_info_cb cb, void *data)
+{
+	return can_handle_foreach_link(NULL, cb, data);
+}
+
+struct link_info_array {
+	struct can_link_info *infos;
+	int max;
+	int n;
+};
+
+static int store_link_info_array(const struct can_link_info *info, void *data)
+{
+	struct link_info_array *array = data;
+
+	if (array->n < array->max)
+		memcpy(&array->infos[array->n], info, sizeof(*info));
+	array->n++;
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_get_all_link_info - can_get_all_link_info using a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ *
+ * Please see can_get_all_link_info for the other parameters and more
+ * information.
+ *
+ * @return number of can interfaces found if success
+ * @return -1 if failed
+ */
+int can_handle_get_all_link_info(struct can_handle *h,
+		struct can_link_info *infos, int max)
+{
+	struct link_info_array array = {
+		.infos = infos,
+		.max = max,
+	};
+
+	if (can_handle_foreach_link(h, store_link_info_array, &array) < 0)
+		return -1;
+
+	return array.n;
+}
+
+/**
+ * @ingroup extern
+ * can_get_all_link_info - get snapshots of all can interfaces
+ *
+ * @param infos array to store the snapshots
+ * @param max number of elements in infos
+ *
+ * This one fills infos with a snapshot (see can_get_link_info) of every
+ * interface of kind "can", taken from a single netlink dump. At most max
+ * elements are filled. If the return value is larger than max, the array was
+ * too small to hold all interfaces.
+ *
+ * @return number of can interfaces found if success
+ * @return -1 if failed
+ */
+int can_get_all_link_info(struct can_link_info *infos, int max)
+{
+	return can_handle_get_all_link_info(NULL, infos, max);
+}
+
+/**
+ * @ingroup intern
+ * @brief monitor_find - find a link in the monitor table
+ *
+ * @param mon link monitor
+ * @param ifindex interface index of the link
+ *
+ * @return pointer to the table entry if found
+ * @return NULL otherwise
+ */
+static struct monitor_link *monitor_find(struct can_monitor *mon, int ifindex)
+{
+	int i;
+
+	for (i = 0; i < mon->nlinks; i++)
+		if (mon->links[i].info.ifindex == ifindex)
+			return &mon->links[i];
+
+	return NULL;
+}
+
+/**
+ * @ingroup intern
+ * @brief monitor_update - apply a link event to the monitor table
+ *
+ * @param mon link monitor
+ * @param event CAN_MONITOR_NEWLINK or CAN_MONITOR_DELLINK
+ * @param info decoded link snapshot of the event
+ *
+ * Updates the last known state of the link and reports the old and the new
+ * snapshot to the user callback.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int monitor_update(struct can_monitor *mon, int event,
+			  const struct can_link_info *info)
+{
+	struct monitor_link *link;
+	struct can_link_info old;
+
+	link = monitor_find(mon, info->ifindex);
+
+	if (event == CAN_MONITOR_DELLINK) {
+		if (link == NULL)
+			return 0;
+
+		old = link->info;
+		*link = mon->links[--mon->nlinks];
+		if (mon->cb)
+			mon->cb(event, &old, info, mon->data);
+
+		return 0;
+	}
+
+	if (link != NULL) {
+		old = link->info;
+		link->info = *info;
+		link->seen = 1;
+		if (mon->cb)
+			mon->cb(event, &old, info, mon->data);
+
+		return 0;
+	}
+
+	if (mon->nlinks == mon->alloc) {
+		int alloc = mon->alloc ? mon->alloc * 2 : 8;
+		struct monitor_link *links;
+
+		links = realloc(mon->links, alloc * sizeof(*links));
+		if (links == NULL) {
+			perror("Cannot grow link table");
+			return -1;
+		}
+		mon->links = links;
+		mon->alloc = alloc;
+	}
+
+	link = &mon->links[mon->nlinks++];
+	link->info = *info;
+	link->seen = 1;
+	if (mon->cb)
+		mon->cb(event, NULL, info, mon->data);
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief monitor_process_msg - decode a link notification
+ *
+ * @param mon link monitor
+ * @param nl_msg netlink message received on the monitor socket
+ *
+ * @return 1 if the message was a can link event
+ * @return 0 if the message was ignored
+ */
+static int monitor_process_msg(struct can_monitor *mon,
+			       struct nlmsghdr *nl_msg)
+{
+	struct ifinfomsg *ifi = NLMSG_DATA(nl_msg);
+	struct rtattr *tb[IFLA_MAX + 1];
+	struct can_link_info info;
+	int type = nl_msg->nlmsg_type;
+	int len;
+
+	if (type != RTM_NEWLINK && type != RTM_DELLINK)
+		return 0;
+
+	len = nl_msg->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	if (len < 0)
+		return 0;
+
+	parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), len);
+	if (!is_can_link(tb))
+		return 0;
+
+	fill_link_info(ifi, tb, &info);
+	monitor_update(mon, type == RTM_DELLINK ?
+		       CAN_MONITOR_DELLINK : CAN_MONITOR_NEWLINK, &info);
+
+	return 1;
+}
+
+/**
+ * @ingroup intern
+ * @brief monitor_link_changed - compare two snapshots of a link
+ *
+ * The statistics change with every frame and are not compared.
+ *
+ * @return 1 if the snapshots differ
+ * @return 0 otherwise
+ */
+static int monitor_link_changed(const struct can_link_info *a,
+				const struct can_link_info *b)
+{
+	struct can_link_info x, y;
+
+	memcpy(&x, a, sizeof(x));
+	memcpy(&y, b, sizeof(y));
+	memset(&x.link_stats, 0, sizeof(x.link_stats));
+	memset(&y.link_stats, 0, sizeof(y.link_stats));
+	memset(&x.device_stats, 0, sizeof(x.device_stats));
+	memset(&y.device_stats, 0, sizeof(y.device_stats));
+	x.valid &= ~(CAN_LINK_INFO_LINK_STATS | CAN_LINK_INFO_DEVICE_STATS);
+	y.valid &= ~(CAN_LINK_INFO_LINK_STATS | CAN_LINK_INFO_DEVICE_STATS);
+
+	return memcmp(&x, &y, sizeof(x)) != 0;
+}
+
+static int monitor_resync_link(const struct can_link_info *info, void *data)
+{
+	struct can_monitor *mon = data;
+	struct monitor_link *link;
+
+	/* take the fresh statistics silently, report changes only */
+	link = monitor_find(mon, info->ifindex);
+	if (link != NULL && !monitor_link_changed(&link->info, info)) {
+		link->info = *info;
+		link->seen = 1;
+		return 0;
+	}
+
+	monitor_update(mon, CAN_MONITOR_NEWLINK, info);
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_monitor_resync - resynchronise a link monitor
+ *
+ * @param mon link monitor as returned by can_monitor_open
+ *
+ * This dumps all can interfaces and reports every difference to the last
+ * known state through the monitor callback, including links which vanished
+ * in between. Links which only differ in their statistics are updated
+ * without invoking the callback. can_monitor_dispatch calls this
+ * automatically if notifications got lost because the socket receive buffer
+ * overran (ENOBUFS).
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_monitor_resync(struct can_monitor *mon)
+{
+	int i;
+
+	if (mon->h == NULL) {
+		mon->h = can_handle_open();
+		if (mon->h == NULL)
+			return -1;
+	}
+
+	for (i = 0; i < mon->nlinks; i++)
+		mon->links[i].seen = 0;
+
+	if (do_walk_nl_link(mon->h, NULL, 0, monitor_resync_link, mon, 0) < 0)
+		return -1;
+
+	for (i = mon->nlinks - 1; i >= 0; i--) {
+		struct can_link_info info;
+
+		if (mon->links[i].seen)
+			continue;
+
+		info = mon->links[i].info;
+		monitor_update(mon, CAN_MONITOR_DELLINK, &info);
+	}
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_monitor_open - open a link monitor
+ *
+ * @param cb callback invoked for every link event
+ * @param data user pointer passed to cb
+ *
+ * This opens a netlink socket subscribed to the RTNLGRP_LINK multicast group.
+ * The kernel notifications about can interfaces can then be read with
+ * can_monitor_dispatch whenever the file descriptor returned by
+ * can_monitor_fd becomes readable. For each notification cb gets the last
+ * known and the new snapshot of the link, e.g. to detect a bus-off:
+ *
+ * @code
+ * static void link_event(int event, const struct can_link_info *old_info,
+ *			  const struct can_link_info *new_info, void *data)
+ * {
+ *	if (event == CAN_MONITOR_NEWLINK && old_info &&
+ *	    old_info->state != new_info->state)
+ *		printf("%s: state %d -> %d\n", new_info->name,
+ *		       old_info->state, new_info->state);
+ * }
+ * @endcode
+ *
+ * The last known state of all can interfaces is initialised with a dump
+ * without invoking cb.
+ *
+ * Note that the kernel only notifies changes of the link itself, e.g. of the
+ * admin state or of the settings. Of the can states, only bus-off (carrier
+ * off) and the restart after it (carrier on) are notified. The transitions
+ * to ERROR_WARNING and ERROR_PASSIVE and changes of the bus error counters
+ * are not, poll them with can_get_link_info or sample them with
+ * can_sampler_open.
+ *
+ * @return pointer to the monitor if success
+ * @return NULL if failed
+ */
+struct can_monitor *can_monitor_open(can_monitor_cb cb, void *data)
+{
+	struct can_monitor *mon;
+	int group = RTNLGRP_LINK;
+	int rcvbuf = 1024 * 1024;
+
+	mon = calloc(1, sizeof(*mon));
+	if (mon == NULL) {
+		perror("Cannot allocate link monitor");
+		return NULL;
+	}
+
+	mon->fd = open_nl_sock();
+	if (mon->fd < 0)
+		goto err_free;
+
+	/* notifications come in bursts, try to survive them */
+	setsockopt(mon->fd, SOL_SOCKET, SO_RCVBUF, (void *)&rcvbuf,
+		   sizeof(rcvbuf));
+
+	if (setsockopt(mon->fd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP,
+		       &group, sizeof(group)) < 0) {
+		perror("Cannot join RTNLGRP_LINK");
+		goto err_close;
+	}
+
+	if (fcntl(mon->fd, F_SETFL, fcntl(mon->fd, F_GETFL) | O_NONBLOCK) < 0) {
+		perror("Cannot set O_NONBLOCK");
+		goto err_close;
+	}
+
+	/* populate the table silently, after we subscribed */
+	if (can_monitor_resync(mon) < 0)
+		goto err_close;
+
+	mon->cb = cb;
+	mon->data = data;
+
+	return mon;
+
+err_close:
+	can_handle_close(mon->h);
+	close(mon->fd);
+err_free:
+	free(mon->links);
+	free(mon);
+	return NULL;
+}
+
+/**
+ * @ingroup extern
+ * can_monitor_close - close a link monitor
+ *
+ * @param mon link monitor as returned by can_monitor_open, may be NULL
+ */
+void can_monitor_close(struct can_monitor *mon)
+{
+	if (mon == NULL)
+		return;
+
+	can_handle_close(mon->h);
+	close(mon->fd);
+	free(mon->links);
+	free(mon->rx.buf);
+	free(mon);
+}
+
+/**
+ * @ingroup extern
+ * can_monitor_fd - get the pollable file descriptor of a link monitor
+ *
+ * @param mon link monitor as returned by can_monitor_open
+ *
+ * The descriptor becomes readable when notifications are pending. Add it to
+ * your poll/select/epoll loop and call can_monitor_dispatch then.
+ *
+ * @return file descriptor
+ */
+int can_monitor_fd(struct can_monitor *mon)
+{
+	return mon->fd;
+}
+
+/**
+ * @ingroup extern
+ * can_monitor_dispatch - process pending link notifications
+ *
+ * @param mon link monitor as returned by can_monitor_open
+ *
+ * This reads all pending notifications without blocking and invokes the
+ * monitor callback for each can link event. If notifications were lost, the
+ * pending ones are discarded and the monitor resynchronises itself with a
+ * dump (see can_monitor_resync).
+ *
+ * @return number of can link events processed if success
+ * @return -1 if failed
+ */
+int can_monitor_dispatch(struct can_monitor *mon)
+{
+	struct nlmsghdr *nl_msg;
+	ssize_t msglen;
+	int events = 0;
+	int lost = 0;
+
+	while (1) {
+		size_t u_msglen;
+
+		msglen = rx_recv(mon->fd, &mon->rx, MSG_DONTWAIT);
+		if (msglen < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			if (errno == ENOBUFS) {
+				lost = 1;
+				continue;
+			}
+			perror("Cannot receive link notification");
+			return -1;
+		}
+
+		/* queued before the resync, older than the dump */
+		if (lost)
+			continue;
+
+		u_msglen = (size_t) msglen;
+		for (nl_msg = (struct nlmsghdr *)mon->rx.buf;
+		     NLMSG_OK(nl_msg, u_msglen);
+		     nl_msg = NLMSG_NEXT(nl_msg, u_msglen))
+			events += monitor_process_msg(mon, nl_msg);
+	}
+
+	if (lost && can_monitor_resync(mon) < 0)
+		return -1;
+
+	return events;
+}
+
+/**
+ * @ingroup extern
+ * can_monitor_get_link_info - get the last known snapshot of a link
+ *
+ * @param mon link monitor as returned by can_monitor_open
+ * @param name name of the can device, e.g. "can0"
+ * @param info pointer to the can_link_info struct.
+ *
+ * This one returns the snapshot of the last notification received for the
+ * interface. It does not talk to the kernel, call can_monitor_dispatch first
+ * to process pending notifications.
+ *
+ * @return 0 if success
+ * @return -1 if the link is not known
+ */
+int can_monitor_get_link_info(struct can_monitor *mon, const char *name,
+		struct can_link_info *info)
+{
+	int i;
+
+	for (i = 0; i < mon->nlinks; i++) {
+		if (strcmp(mon->links[i].info.name, name) == 0) {
+			*info = mon->links[i].info;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * @ingroup intern
+ * @brief supervisor_find - find a link in the supervisor table
+ *
+ * @param sup bus-off supervisor
+ * @param ifindex interface index of the link
+ *
+ * @return pointer to the table entry if found
+ * @return NULL otherwise
+ */
+static struct supervised_link *supervisor_find(struct can_supervisor *sup,
+					       int ifindex)
+{
+	int i;
+
+	for (i = 0; i < sup->nlinks; i++)
+		if (sup->links[i].rec.ifindex == ifindex)
+			return &sup->links[i];
+
+	return NULL;
+}
+
+static struct supervised_link *supervisor_find_name(struct can_supervisor *sup,
+						    const char *name)
+{
+	int i;
+
+	for (i = 0; i < sup->nlinks; i++)
+		if (strcmp(sup->links[i].rec.name, name) == 0)
+			return &sup->links[i];
+
+	return NULL;
+}
+
+/**
+ * @ingroup intern
+ * @brief supervisor_delay - get the delay of the next restart of a link
+ *
+ * The delay starts at backoff_ms and doubles with every restart up to
+ * backoff_max_ms.
+ */
+static __u32 supervisor_delay(const struct can_supervisor_opts *opts,
+			      const struct supervised_link *l)
+{
+	__u32 delay = opts->backoff_ms;
+	int i;
+
+	if (opts->backoff_max_ms == 0)
+		return delay;
+
+	for (i = 0; i < l->streak && delay < opts->backoff_max_ms; i++)
+		delay = delay ? delay * 2 : 1;
+
+	return delay < opts->backoff_max_ms ? delay : opts->backoff_max_ms;
+}
+
+static void supervisor_event(struct can_supervisor *sup, int event,
+			     const struct supervised_link *l)
+{
+	if (sup->cb)
+		sup->cb(event, &l->rec, sup->data);
+}
+
+/**
+ * @ingroup intern
+ * @brief supervisor_schedule - schedule the restart of a bus-off link
+ *
+ * @param sup bus-off supervisor
+ * @param l link in bus-off
+ * @param now current time, see monotonic_us
+ *
+ * The restart is due after the backoff delay. If the budget is used up, it
+ * is postponed to the end of the budget window, or the supervisor gives up
+ * on the link if the budget is for its lifetime.
+ */
+static void supervisor_schedule(struct can_supervisor *sup,
+				struct supervised_link *l, __u64 now)
+{
+	const struct can_supervisor_opts *opts = &sup->opts;
+	__u64 due;
+
+	if (l->rec.given_up || l->auto_restart)
+		return;
+
+	l->rec.delay_ms = supervisor_delay(opts, l);
+	due = now + (__u64)l->rec.delay_ms * 1000;
+
+	if (opts->budget && l->window_restarts >= opts->budget) {
+		__u64 end = l->window_us + (__u64)opts->budget_ms * 1000;
+
+		if (opts->budget_ms == 0) {
+			l->rec.given_up = 1;
+			l->due_us = 0;
+			supervisor_event(sup, CAN_SUPERVISOR_GIVE_UP, l);
+			return;
+		}
+		if (due < end)
+			due = end;
+	}
+
+	l->due_us = due;
+}
+
+/**
+ * @ingroup intern
+ * @brief supervisor_restart - send the prebuilt restart request of a link
+ *
+ * @param sup bus-off supervisor
+ * @param l link with a due restart
+ * @param now current time, see monotonic_us
+ *
+ * A rejected restart is retried after the next backoff delay, unless the
+ * kernel says the link is no longer bus-off (EBUSY), in which case the
+ * notification about it is on the way.
+ */
+static void supervisor_restart(struct can_supervisor *sup,
+			       struct supervised_link *l, __u64 now)
+{
+	const struct can_supervisor_opts *opts = &sup->opts;
+
+	l->due_us = 0;
+
+	if (opts->budget_ms &&
+	    now - l->window_us >= (__u64)opts->budget_ms * 1000) {
+		l->window_us = now;
+		l->window_restarts = 0;
+	}
+	l->window_restarts++;
+	l->streak++;
+	l->rec.restarts++;
+
+	if (send_mod_request(sup->h, &l->restart.n) == 0) {
+		supervisor_event(sup, CAN_SUPERVISOR_RESTART, l);
+		return;
+	}
+
+	l->rec.restart_errors++;
+	supervisor_event(sup, CAN_SUPERVISOR_RESTART_FAILED, l);
+	if (errno != EBUSY)
+		supervisor_schedule(sup, l, now);
+}
+
+/**
+ * @ingroup intern
+ * @brief supervisor_update - apply a link snapshot to the supervisor table
+ *
+ * @param sup bus-off supervisor
+ * @param info new snapshot of the link
+ * @param now current time, see monotonic_us
+ *
+ * Detects the transitions into and out of bus-off. The time to recovery is
+ * measured from the first notification about the bus-off to the first one
+ * about an active state again.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int supervisor_update(struct can_supervisor *sup,
+			     const struct can_link_info *info, __u64 now)
+{
+	const struct can_supervisor_opts *opts = &sup->opts;
+	struct supervised_link *l;
+
+	l = supervisor_find(sup, info->ifindex);
+	if (l == NULL) {
+		struct req_info req_info = {
+			.restart = 1,
+		};
+
+		if (sup->nlinks == sup->alloc) {
+			int alloc = sup->alloc ? sup->alloc * 2 : 8;
+			struct supervised_link *links;
+
+			links = realloc(sup->links, alloc * sizeof(*links));
+			if (links == NULL) {
+				perror("Cannot grow link table");
+				return -1;
+			}
+			sup->links = links;
+			sup->alloc = alloc;
+		}
+
+		l = &sup->links[sup->nlinks];
+		memset(l, 0, sizeof(*l));
+		l->rec.ifindex = info->ifindex;
+		l->rec.state = CAN_STATE_STOPPED;
+
+		/* by index, so that renames do not matter */
+		if (build_set_req(&l->restart, 0, NULL, info->ifindex,
+				  &req_info) < 0)
+			return -1;
+		sup->nlinks++;
+	}
+
+	memcpy(l->rec.name, info->name, sizeof(l->rec.name));
+	l->auto_restart = info->restart_ms > 0;
+
+	if (!(info->valid & CAN_LINK_INFO_STATE))
+		return 0;
+
+	if (info->state == CAN_STATE_BUS_OFF && l->bus_off_us == 0) {
+		l->rec.state = info->state;
+		l->rec.bus_offs++;
+		l->bus_off_us = now;
+
+		/* a bus-off long after the last one starts over */
+		if (now - l->recovered_us > (__u64)opts->stable_ms * 1000)
+			l->streak = 0;
+		l->rec.delay_ms = supervisor_delay(opts, l);
+
+		supervisor_event(sup, CAN_SUPERVISOR_BUS_OFF, l);
+		supervisor_schedule(sup, l, now);
+	} else if (info->state != CAN_STATE_BUS_OFF && l->bus_off_us) {
+		l->rec.state = info->state;
+		l->due_us = 0;
+
+		/* stopping the link is no recovery */
+		if (info->state < CAN_STATE_BUS_OFF) {
+			l->rec.last_us = now - l->bus_off_us;
+			if (l->rec.last_us > l->rec.max_us)
+				l->rec.max_us = l->rec.last_us;
+			l->rec.total_us += l->rec.last_us;
+			l->rec.recoveries++;
+			l->recovered_us = now;
+			supervisor_event(sup, CAN_SUPERVISOR_RECOVERED, l);
+		}
+		l->bus_off_us = 0;
+	} else {
+		l->rec.state = info->state;
+	}
+
+	return 0;
+}
+
+static void supervisor_link_event(int event,
+				  const struct can_link_info *old_info,
+				  const struct can_link_info *new_info,
+				  void *data)
+{
+	struct can_supervisor *sup = data;
+	struct supervised_link *l;
+
+	(void)old_info;
+
+	if (event == CAN_MONITOR_NEWLINK) {
+		supervisor_update(sup, new_info, monotonic_us());
+		return;
+	}
+
+	l = supervisor_find(sup, new_info->ifindex);
+	if (l != NULL)
+		*l = sup->links[--sup->nlinks];
+}
+
+/**
+ * @ingroup extern
+ * can_supervisor_open - open a bus-off supervisor
+ *
+ * @param opts restart policy, or NULL to restart at once and without limit
+ * @param cb callback invoked for every supervisor event, may be NULL
+ * @param data user pointer passed to cb
+ *
+ * The supervisor watches the link notifications of all can interfaces (see
+ * can_monitor_open) and restarts every interface which goes bus-off. The
+ * restart request of each interface is built once and sent on a netlink
+ * socket which stays open, so a restart costs a single round trip.
+ *
+ * The restart is delayed by backoff_ms. If backoff_max_ms is set, the delay
+ * doubles with every restart up to it, until the interface stays out of
+ * bus-off for stable_ms. If budget is set, at most budget restarts are
+ * requested within budget_ms, or within the lifetime of the supervisor if
+ * budget_ms is 0, in which case it gives up on the interface then.
+ *
+ * Interfaces with restart_ms set are restarted by the kernel, the supervisor
+ * only records their recovery. Interfaces which are bus-off already when the
+ * supervisor is opened are reported and restarted as well. For every bus-off
+ * the time until the kernel reports an active state again is recorded, see
+ * can_supervisor_get_recovery.
+ *
+ * The supervisor runs from your poll loop: wait for can_supervisor_fd to
+ * become readable, at most can_supervisor_timeout milliseconds, and call
+ * can_supervisor_dispatch then.
+ *
+ * @return pointer to the supervisor if success
+ * @return NULL if failed
+ */
+struct can_supervisor *can_supervisor_open(const struct can_supervisor_opts *opts,
+					   can_supervisor_cb cb, void *data)
+{
+	struct can_supervisor *sup;
+	__u64 now;
+	int i;
+
+	sup = calloc(1, sizeof(*sup));
+	if (sup == NULL) {
+		perror("Cannot allocate bus-off supervisor");
+		return NULL;
+	}
+
+	if (opts != NULL)
+		sup->opts = *opts;
+	sup->cb = cb;
+	sup->data = data;
+
+	sup->h = can_handle_open();
+	if (sup->h == NULL)
+		goto err_free;
+
+	sup->mon = can_monitor_open(supervisor_link_event, sup);
+	if (sup->mon == NULL)
+		goto err_close;
+
+	/* the monitor learned the links silently, catch up */
+	now = monotonic_us();
+	for (i = 0; i < sup->mon->nlinks; i++)
+		if (supervisor_update(sup, &sup->mon->links[i].info, now) < 0)
+			goto err_close;
+
+	return sup;
+
+err_close:
+	can_monitor_close(sup->mon);
+	can_handle_close(sup->h);
+err_free:
+	free(sup->links);
+	free(sup);
+	return NULL;
+}
+
+/**
+ * @ingroup extern
+ * can_supervisor_close - close a bus-off supervisor
+ *
+ * @param sup bus-off supervisor as returned by can_supervisor_open, may be
+ * NULL
+ */
+void can_supervisor_close(struct can_supervisor *sup)
+{
+	if (sup == NULL)
+		return;
+
+	can_monitor_close(sup->mon);
+	can_handle_close(sup->h);
+	free(sup->links);
+	free(sup);
+}
+
+/**
+ * @ingroup extern
+ * can_supervisor_fd - get the pollable file descriptor of a supervisor
+ *
+ * @param sup bus-off supervisor as returned by can_supervisor_open
+ *
+ * @return file descriptor
+ */
+int can_supervisor_fd(struct can_supervisor *sup)
+{
+	return can_monitor_fd(sup->mon);
+}
+
+/**
+ * @ingroup extern
+ * can_supervisor_timeout - get the time until the next restart is due
+ *
+ * @param sup bus-off supervisor as returned by can_supervisor_open
+ *
+ * Use this as timeout of poll, so that can_supervisor_dispatch is called in
+ * time for delayed restarts.
+ *
+ * @return milliseconds until the next restart, 0 if one is due
+ * @return -1 if no restart is pending
+ */
+int can_supervisor_timeout(struct can_supervisor *sup)
+{
+	__u64 due = 0, now;
+	int i;
+
+	for (i = 0; i < sup->nlinks; i++)
+		if (sup->links[i].due_us &&
+		    (due == 0 || sup->links[i].due_us < due))
+			due = sup->links[i].due_us;
+
+	if (due == 0)
+		return -1;
+
+	now = monotonic_us();
+	if (due <= now)
+		return 0;
+
+	/* round up, poll must not return before the restart is due */
+	return (due - now + 999) / 1000;
+}
+
+/**
+ * @ingroup extern
+ * can_supervisor_dispatch - process link notifications and due restarts
+ *
+ * @param sup bus-off supervisor as returned by can_supervisor_open
+ *
+ * This reads all pending notifications without blocking, like
+ * can_monitor_dispatch, and sends the restart requests which are due.
+ *
+ * @return number of can link events processed if success
+ * @return -1 if failed
+ */
+int can_supervisor_dispatch(struct can_supervisor *sup)
+{
+	int events, i;
+	__u64 now;
+
+	events = can_monitor_dispatch(sup->mon);
+	if (events < 0)
+		return -1;
+
+	now = monotonic_us();
+	for (i = 0; i < sup->nlinks; i++)
+		if (sup->links[i].due_us && sup->links[i].due_us <= now)
+			supervisor_restart(sup, &sup->links[i], now);
+
+	return events;
+}
+
+/**
+ * @ingroup extern
+ * can_supervisor_get_recovery - get the recovery record of a link
+ *
+ * @param sup bus-off supervisor as returned by can_supervisor_open
+ * @param name name of the can device, e.g. "can0"
+ * @param rec pointer to the can_recovery struct.
+ *
+ * @return 0 if success
+ * @return -1 if the link is not known
+ */
+int can_supervisor_get_recovery(struct can_supervisor *sup, const char *name,
+				struct can_recovery *rec)
+{
+	struct supervised_link *l;
+
+	l = supervisor_find_name(sup, name);
+	if (l == NULL)
+		return -1;
+
+	*rec = l->rec;
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_supervisor_rearm - resume restarting a link
+ *
+ * @param sup bus-off supervisor as returned by can_supervisor_open
+ * @param name name of the can device, e.g. "can0"
+ *
+ * This resets the budget and the backoff delay of the link, e.g. after the
+ * supervisor gave up on it and the bus was repaired. A link which is still
+ * bus-off is restarted with the next can_supervisor_dispatch.
+ *
+ * @return 0 if success
+ * @return -1 if the link is not known
+ */
+int can_supervisor_rearm(struct can_supervisor *sup, const char *name)
+{
+	struct supervised_link *l;
+	__u64 now = monotonic_us();
+
+	l = supervisor_find_name(sup, name);
+	if (l == NULL)
+		return -1;
+
+	l->rec.given_up = 0;
+	l->streak = 0;
+	l->window_us = now;
+	l->window_restarts = 0;
+	if (l->bus_off_us && !l->auto_restart)
+		l->due_us = now;
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief sampler_find - find a link in the sampler table
+ *
+ * @param s link statistics sampler
+ * @param ifindex interface index of the link
+ *
+ * @return pointer to the table entry if found
+ * @return NULL otherwise
+ */
+static struct sampled_link *sampler_find(struct can_sampler *s, int ifindex)
+{
+	int i;
+
+	for (i = 0; i < s->nlinks; i++)
+		if (s->links[i].ifindex == ifindex)
+			return &s->links[i];
+
+	return NULL;
+}
+
+static struct sampled_link *sampler_find_name(struct can_sampler *s,
+					      const char *name)
+{
+	int i;
+
+	for (i = 0; i < s->nlinks; i++)
+		if (strcmp(s->links[i].name, name) == 0)
+			return &s->links[i];
+
+	return NULL;
+}
+
+/*
+ * Increment of a counter. A 64 bit counter which went backwards was reset,
+ * e.g. by the driver, and counts from zero again.
+ */
+#define COUNTER_DELTA(cur, prev) ((cur) >= (prev) ? (cur) - (prev) : (cur))
+
+/*
+ * Increment of a 32 bit counter of struct can_device_stats. These wrap in
+ * normal operation, so the increment is taken modulo 2^32. A counter cannot
+ * plausibly advance by 2^31 or more within one sample interval, such an
+ * increment means the counter went backwards because it was reset, and it
+ * counts from zero again.
+ */
+static __u32 counter_delta32(__u32 cur, __u32 prev)
+{
+	__u32 delta = cur - prev;
+
+	return delta < 0x80000000U ? delta : cur;
+}
+
+/**
+ * @ingroup intern
+ * @brief sampler_link - record the snapshot of a link from the sampler dump
+ *
+ * The first snapshot of a link is only the base of the next sample. A link
+ * which cannot be added to the table is skipped until the next dump.
+ */
+static int sampler_link(const struct can_link_info *info, void *data)
+{
+	struct can_sampler *s = data;
+	struct sampled_link *l;
+	struct can_sample *sample;
+	const __u64 *cur64, *prev64;
+	const __u32 *cur32, *prev32;
+	__u64 *delta64;
+	__u32 *delta32;
+	unsigned int i;
+
+	l = sampler_find(s, info->ifindex);
+	if (l == NULL) {
+		if (s->nlinks == s->alloc) {
+			int alloc = s->alloc ? s->alloc * 2 : 8;
+			struct sampled_link *links;
+
+			links = realloc(s->links, alloc * sizeof(*links));
+			if (links == NULL) {
+				perror("Cannot grow link table");
+				return 0;
+			}
+			s->links = links;
+			s->alloc = alloc;
+		}
+
+		l = &s->links[s->nlinks];
+		memset(l, 0, sizeof(*l));
+		l->ifindex = info->ifindex;
+		l->ring = calloc(s->depth, sizeof(*l->ring));
+		if (l->ring == NULL) {
+			perror("Cannot allocate sample ring");
+			return 0;
+		}
+		s->nlinks++;
+	}
+
+	memcpy(l->name, info->name, sizeof(l->name));
+	l->seen = 1;
+
+	if (!l->have_prev) {
+		l->prev = *info;
+		l->prev_us = s->now_us;
+		l->have_prev = 1;
+		return 0;
+	}
+
+	sample = &l->ring[l->head];
+	memset(sample, 0, sizeof(*sample));
+	sample->time_us = s->now_us;
+	sample->interval_us = s->now_us - l->prev_us;
+	sample->valid = info->valid & (CAN_LINK_INFO_STATE |
+				       CAN_LINK_INFO_BERR_COUNTER);
+	sample->state = info->state;
+	sample->berr_counter = info->berr_counter;
+
+	/* increments need the counters of both snapshots */
+	if (info->valid & l->prev.valid & CAN_LINK_INFO_LINK_STATS) {
+		cur64 = (const __u64 *)&info->link_stats;
+		prev64 = (const __u64 *)&l->prev.link_stats;
+		delta64 = (__u64 *)&sample->link_stats;
+		for (i = 0; i < sizeof(sample->link_stats) / sizeof(*delta64); i++)
+			delta64[i] = COUNTER_DELTA(cur64[i], prev64[i]);
+		sample->valid |= CAN_LINK_INFO_LINK_STATS;
+	}
+
+	if (info->valid & l->prev.valid & CAN_LINK_INFO_DEVICE_STATS) {
+		cur32 = (const __u32 *)&info->device_stats;
+		prev32 = (const __u32 *)&l->prev.device_stats;
+		delta32 = (__u32 *)&sample->device_stats;
+		for (i = 0; i < sizeof(sample->device_stats) / sizeof(*delta32); i++)
+			delta32[i] = counter_delta32(cur32[i], prev32[i]);
+		sample->valid |= CAN_LINK_INFO_DEVICE_STATS;
+	}
+
+	l->prev = *info;
+	l->prev_us = s->now_us;
+	l->head = (l->head + 1) % s->depth;
+	if (l->count < s->depth)
+		l->count++;
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_sampler_sample - take a sample of all can interfaces now
+ *
+ * @param s link statistics sampler as returned by can_sampler_open
+ *
+ * This takes a sample out of schedule, can_sampler_dispatch calls it when a
+ * sample is due. All interfaces are sampled with a single dump and share the
+ * time of the sample. Interfaces which vanished are dropped with their
+ * history.
+ *
+ * @return number of can interfaces sampled if success
+ * @return -1 if failed
+ */
+int can_sampler_sample(struct can_sampler *s)
+{
+	int i, n;
+
+	for (i = 0; i < s->nlinks; i++)
+		s->links[i].seen = 0;
+
+	s->now_us = monotonic_us();
+	n = do_walk_nl_link(s->h, NULL, 0, sampler_link, s, 0);
+	if (n < 0)
+		return -1;
+
+	for (i = s->nlinks - 1; i >= 0; i--) {
+		if (s->links[i].seen)
+			continue;
+
+		free(s->links[i].ring);
+		s->links[i] = s->links[--s->nlinks];
+	}
+
+	return n;
+}
+
+/**
+ * @ingroup extern
+ * can_sampler_open - open a link statistics sampler
+ *
+ * @param interval_ms time between two samples
+ * @param depth number of samples kept per interface
+ *
+ * The sampler takes a snapshot of the statistics of all can interfaces
+ * every interval_ms, timestamped with CLOCK_MONOTONIC, and keeps the
+ * increments since the previous one in a ring of depth samples per
+ * interface. Rates over the last samples are computed from the ring
+ * without talking to the kernel, see can_sampler_get_rates.
+ *
+ * The base snapshot is taken right away. The sampler runs from your poll
+ * loop: wait at most can_sampler_timeout milliseconds and call
+ * can_sampler_dispatch then.
+ *
+ * @return pointer to the sampler if success
+ * @return NULL if failed
+ */
+struct can_sampler *can_sampler_open(__u32 interval_ms, int depth)
+{
+	struct can_sampler *s;
+
+	if (interval_ms == 0 || depth < 1) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	s = calloc(1, sizeof(*s));
+	if (s == NULL) {
+		perror("Cannot allocate link statistics sampler");
+		return NULL;
+	}
+
+	s->interval_us = (__u64)interval_ms * 1000;
+	s->depth = depth;
+
+	s->h = can_handle_open();
+	if (s->h == NULL)
+		goto err_free;
+
+	if (can_sampler_sample(s) < 0)
+		goto err_close;
+
+	s->due_us = s->now_us + s->interval_us;
+
+	return s;
+
+err_close:
+	can_sampler_close(s);
+	return NULL;
+
+err_free:
+	free(s);
+	return NULL;
+}
+
+/**
+ * @ingroup extern
+ * can_sampler_close - close a link statistics sampler
+ *
+ * @param s link statistics sampler as returned by can_sampler_open, may be
+ * NULL
+ */
+void can_sampler_close(struct can_sampler *s)
+{
+	int i;
+
+	if (s == NULL)
+		return;
+
+	for (i = 0; i < s->nlinks; i++)
+		free(s->links[i].ring);
+	free(s->links);
+	can_handle_close(s->h);
+	free(s);
+}
+
+/**
+ * @ingroup extern
+ * can_sampler_timeout - get the time until the next sample is due
+ *
+ * @param s link statistics sampler as returned by can_sampler_open
+ *
+ * @return milliseconds until the next sample, 0 if one is due
+ */
+int can_sampler_timeout(struct can_sampler *s)
+{
+	__u64 now = monotonic_us();
+
+	if (s->due_us <= now)
+		return 0;
+
+	/* round up, poll must not return before the sample is due */
+	return (s->due_us - now + 999) / 1000;
+}
+
+/**
+ * @ingroup extern
+ * can_sampler_dispatch - take a sample if one is due
+ *
+ * @param s link statistics sampler as returned by can_sampler_open
+ *
+ * Samples are due at a fixed rate. If the caller fell behind by more than an
+ * interval, the missed samples are skipped, the next sample then covers the
+ * whole time since the previous one.
+ *
+ * @return number of can interfaces sampled, 0 if no sample was due
+ * @return -1 if failed
+ */
+int can_sampler_dispatch(struct can_sampler *s)
+{
+	int n;
+
+	if (s->due_us > monotonic_us())
+		return 0;
+
+	n = can_sampler_sample(s);
+
+	s->due_us += s->interval_us;
+	if (s->due_us <= s->now_us)
+		s->due_us = s->now_us + s->interval_us;
+
+	return n;
+}
+
+/**
+ * @ingroup extern
+ * can_sampler_get_history - get the samples of a link
+ *
+ * @param s link statistics sampler as returned by can_sampler_open
+ * @param name name of the can device, e.g. "can0"
+ * @param samples array to store the samples, the newest first
+ * @param max number of elements in samples
+ *
+ * @return number of samples stored if success
+ * @return -1 if the link is not known
+ */
+int can_sampler_get_history(struct can_sampler *s, const char *name,
+		struct can_sample *samples, int max)
+{
+	struct sampled_link *l;
+	int i;
+
+	l = sampler_find_name(s, name);
+	if (l == NULL)
+		return -1;
+
+	for (i = 0; i < l->count && i < max; i++)
+		samples[i] = l->ring[(l->head - 1 - i + s->depth) % s->depth];
+
+	return i;
+}
+
+/**
+ * @ingroup extern
+ * can_sampler_get_rates - get the rates of a link
+ *
+ * @param s link statistics sampler as returned by can_sampler_open
+ * @param name name of the can device, e.g. "can0"
+ * @param n number of samples to compute the rates over, at most the depth
+ * of the sampler. 0 means the last sample only.
+ * @param rates pointer to the can_rates struct.
+ *
+ * Rates of counters which the link does not report are 0. Fewer samples
+ * than requested are used while the history fills up.
+ *
+ * @return 0 if success
+ * @return -1 if the link is not known or has no sample yet
+ */
+int can_sampler_get_rates(struct can_sampler *s, const char *name, int n,
+		struct can_rates *rates)
+{
+	struct rtnl_link_stats64 ls;
+	struct can_device_stats ds;
+	struct sampled_link *l;
+	__u64 interval = 0;
+	double per_s;
+	int i;
+
+	l = sampler_find_name(s, name);
+	if (l == NULL || l->count == 0)
+		return -1;
+
+	if (n < 1)
+		n = 1;
+	if (n > l->count)
+		n = l->count;
+
+	memset(&ls, 0, sizeof(ls));
+	memset(&ds, 0, sizeof(ds));
+	for (i = 0; i < n; i++) {
+		const struct can_sample *sample =
+		    &l->ring[(l->head - 1 - i + s->depth) % s->depth];
+
+		interval += sample->interval_us;
+		if (sample->valid & CAN_LINK_INFO_LINK_STATS) {
+			ls.rx_packets += sample->link_stats.rx_packets;
+			ls.tx_packets += sample->link_stats.tx_packets;
+			ls.rx_bytes += sample->link_stats.rx_bytes;
+			ls.tx_bytes += sample->link_stats.tx_bytes;
+			ls.rx_errors += sample->link_stats.rx_errors;
+			ls.tx_errors += sample->link_stats.tx_errors;
+		}
+		if (sample->valid & CAN_LINK_INFO_DEVICE_STATS) {
+			ds.bus_error += sample->device_stats.bus_error;
+			ds.restarts += sample->device_stats.restarts;
+		}
+	}
+
+	memset(rates, 0, sizeof(*rates));
+	rates->interval_us = interval;
+	if (interval == 0)
+		return 0;
+
+	per_s = 1000000.0 / interval;
+	rates->rx_frames = ls.rx_packets * per_s;
+	rates->tx_frames = ls.tx_packets * per_s;
+	rates->rx_bytes = ls.rx_bytes * per_s;
+	rates->tx_bytes = ls.tx_bytes * per_s;
+	rates->rx_errors = ls.rx_errors * per_s;
+	rates->tx_errors = ls.tx_errors * per_s;
+	rates->bus_errors = ds.bus_error * per_s;
+	rates->restarts = ds.restarts * per_s * 60;
+
+	return 0;
+}
+
+/**
+ * @ingroup extern
+ * can_sampler_get_busload - estimate the bus load of a link
+ *
+ * @param s link statistics sampler as returned by can_sampler_open
+ * @param name name of the can device, e.g. "can0"
+ * @param n number of samples to estimate the load over, see
+ * can_sampler_get_rates
+ * @param flags CAN_BUSLOAD_EXTENDED if the bus uses 29 bit identifiers
+ * @param load pointer to the can_busload struct.
+ *
+ * This passes the frames and bytes the link sent and received in the last
+ * samples to can_calc_busload, with the bitrates of the last snapshot of
+ * the link. If the link is in CAN FD mode, the frames are counted as CAN FD
+ * frames with bitrate switch.
+ *
+ * @return 0 if success
+ * @return -1 if the link is not known, has no sample or no bitrate yet
+ */
+int can_sampler_get_busload(struct can_sampler *s, const char *name, int n,
+		__u32 flags, struct can_busload *load)
+{
+	const struct can_link_info *info;
+	struct sampled_link *l;
+	__u64 frames = 0, bytes = 0, interval = 0;
+	__u32 dbitrate = 0;
+	int i;
+
+	l = sampler_find_name(s, name);
+	if (l == NULL || l->count == 0)
+		return -1;
+
+	info = &l->prev;
+	if (!(info->valid & CAN_LINK_INFO_BITTIMING) ||
+	    info->bittiming.bitrate == 0)
+		return -1;
+
+	if ((info->valid & CAN_LINK_INFO_CTRLMODE) &&
+	    (info->ctrlmode.flags & CAN_CTRLMODE_FD)) {
+		flags |= CAN_BUSLOAD_FD;
+		if (info->valid & CAN_LINK_INFO_DATA_BITTIMING)
+			dbitrate = info->data_bittiming.bitrate;
+	}
+
+	if (n < 1)
+		n = 1;
+	if (n > l->count)
+		n = l->count;
+
+	for (i = 0; i < n; i++) {
+		const struct can_sample *sample =
+		    &l->ring[(l->head - 1 - i + s->depth) % s->depth];
+
+		interval += sample->interval_us;
+		if (sample->valid & CAN_LINK_INFO_LINK_STATS) {
+			frames += sample->link_stats.rx_packets +
+				  sample->link_stats.tx_packets;
+			bytes += sample->link_stats.rx_bytes +
+				 sample->link_stats.tx_bytes;
+		}
+	}
+
+	return can_calc_busload(frames, bytes, interval,
+				info->bittiming.bitrate, dbitrate, flags, load);
+}
+
+/**
+ * @ingroup intern
+ * @brief shm_write - update a slot of the shared memory
+ *
+ * @param slot slot to update
+ * @param info new snapshot, or NULL to free the slot
+ *
+ * The sequence number is odd while the slot is written, readers retry until
+ * they copied the slot with the same even sequence number before and after.
+ */
+static void shm_write(struct shm_slot *slot, const struct can_link_info *info)
+{
+	__u32 seq = slot->seq;
+
+	__atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	if (info != NULL)
+		slot->info = *info;
+	else
+		memset(&slot->info, 0, sizeof(slot->info));
+
+	__atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @ingroup intern
+ * @brief shm_read - copy a slot of the shared memory
+ *
+ * @param slot slot to copy
+ * @param info pointer to store the snapshot
+ *
+ * @return 0 if success
+ * @return -1 if the slot was not stable, errno is set to EAGAIN then
+ */
+static int shm_read(const struct shm_slot *slot, struct can_link_info *info)
+{
+	__u32 seq;
+	int i;
+
+	for (i = 0; i < SHM_READ_RETRIES; i++) {
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		if (seq & 1)
+			continue;
+
+		*info = slot->info;
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq)
+			return 0;
+	}
+
+	errno = EAGAIN;
+
+	return -1;
+}
+
+/**
+ * @ingroup intern
+ * @brief publish - write the snapshot of a link into its slot
+ *
+ * @param pub snapshot publisher
+ * @param info snapshot of the link
+ * @param del 1 if the link disappeared
+ *
+ * A new link takes the first free slot. If there is none, it is not
+ * published.
+ */
+static void publish(struct can_publisher *pub, const struct can_link_info *info,
+		    int del)
+{
+	int i, slot = -1;
+
+	for (i = 0; i < pub->max_links; i++) {
+		if (pub->slot_ifindex[i] == info->ifindex) {
+			slot = i;
+			break;
+		}
+		if (slot < 0 && pub->slot_ifindex[i] == 0)
+			slot = i;
+	}
+
+	if (slot < 0)
+		return;
+
+	if (del) {
+		if (pub->slot_ifindex[slot] != info->ifindex)
+			return;
+		pub->slot_ifindex[slot] = 0;
+		shm_write(&pub->shm->slots[slot], NULL);
+	} else {
+		pub->slot_ifindex[slot] = info->ifindex;
+		pub->slot_seen[slot] = 1;
+		shm_write(&pub->shm->slots[slot], info);
+	}
+
+	__atomic_store_n(&pub->shm->update_us, monotonic_us(), __ATOMIC_RELEASE);
+}
+
+static void publisher_link_event(int event,
+				 const struct can_link_info *old_info,
+				 const struct can_link_info *new_info,
+				 void *data)
+{
+	(void)old_info;
+
+	publish(data, new_info, event == CAN_MONITOR_DELLINK);
+}
+
+static int publisher_refresh_link(const struct can_link_info *info,
+				  void *data)
+{
+	publish(data, info, 0);
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief publisher_refresh - publish fresh snapshots of all can interfaces
+ *
+ * Notifications only come with changes of the link, the counters are
+ * refreshed with a dump. Slots of links which the dump did not report are
+ * freed.
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+static int publisher_refresh(struct can_publisher *pub)
+{
+	int i;
+
+	for (i = 0; i < pub->max_links; i++)
+		pub->slot_seen[i] = 0;
+
+	if (do_walk_nl_link(pub->h, NULL, 0, publisher_refresh_link, pub, 0) < 0)
+		return -1;
+
+	for (i = 0; i < pub->max_links; i++) {
+		if (pub->slot_ifindex[i] == 0 || pub->slot_seen[i])
+			continue;
+
+		pub->slot_ifindex[i] = 0;
+		shm_write(&pub->shm->slots[i], NULL);
+	}
+
+	/* also without any link, readers see that the publisher is alive */
+	__atomic_store_n(&pub->shm->update_us, monotonic_us(), __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+/**
+ * @ingroup intern
+ * @brief shm_claim - make way for the object of a new publisher
+ *
+ * @param shm_name name of the shared memory object
+ *
+ * A publisher holds an exclusive flock on its object as long as it runs. An
+ * object nobody holds was left by a publisher which is gone and is removed,
+ * its readers keep it.
+ *
+ * @return 0 if the name is free
+ * @return -1 if failed, errno is set to EBUSY if another publisher runs
+ */
+static int shm_claim(const char *shm_name)
+{
+	int fd, ret;
+
+	fd = shm_open(shm_name, O_RDONLY, 0);
+	if (fd < 0) {
+		if (errno == ENOENT)
+			return 0;
+		perror("Cannot open shared memory");
+		return -1;
+	}
+
+	if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+		if (errno == EWOULDBLOCK) {
+			fprintf(stderr, "Shared memory %s is used by another "
+				"publisher\n", shm_name);
+			errno = EBUSY;
+		} else {
+			perror("Cannot lock shared memory");
+		}
+		close(fd);
+		return -1;
+	}
+
+	ret = shm_unlink(shm_name);
+	if (ret < 0 && errno != ENOENT)
+		perror("Cannot remove shared memory");
+	else
+		ret = 0;
+	close(fd);
+
+	return ret;
+}
+
+/**
+ * @ingroup intern
+ * @brief shm_owned - check that the name still refers to the own object
+ *
+ * @param pub snapshot publisher
+ *
+ * @return 1 if the name refers to the object of pub
+ * @return 0 otherwise
+ */
+static int shm_owned(const struct can_publisher *pub)
+{
+	struct stat own, cur;
+	int fd, ret;
+
+	fd = shm_open(pub->shm_name, O_RDONLY, 0);
+	if (fd < 0)
+		return 0;
+
+	ret = fstat(pub->shm_fd, &own) == 0 && fstat(fd, &cur) == 0 &&
+	      own.st_dev == cur.st_dev && own.st_ino == cur.st_ino;
+	close(fd);
+
+	return ret;
+}
+
+/**
+ * @ingroup extern
+ * can_publisher_open - publish the snapshots of all can interfaces
+ *
+ * @param shm_name name of the shared memory object, e.g.
+ * CAN_PUBLISH_DEFAULT
+ * @param max_links number of interfaces which can be published
+ * @param interval_ms time between two refreshes of the counters
+ *
+ * This creates the shared memory object and keeps a snapshot (see
+ * can_get_link_info) of every can interface in it, for any number of
+ * processes to read with can_reader_open. State changes are published as
+ * the kernel notifies them, see can_monitor_open, the counters are
+ * refreshed with a single dump every interval_ms. So the kernel serves one
+ * process instead of every reader.
+ *
+ * The publisher runs from your poll loop: wait for can_publisher_fd to
+ * become readable, at most can_publisher_timeout milliseconds, and call
+ * can_publisher_dispatch then. The canpublishd daemon does just that.
+ *
+ * Only one publisher runs per name, a second one fails with EBUSY. An object
+ * left by a publisher which is gone is removed and a new one is created.
+ * Readers of the previous publisher keep the old object, can_reader_age_ms
+ * tells them it is no longer updated and they have to open the new one.
+ *
+ * @return pointer to the publisher if success
+ * @return NULL if failed, errno is set to EBUSY if another publisher uses
+ * shm_name
+ */
+struct can_publisher *can_publisher_open(const char *shm_name, int max_links,
+		__u32 interval_ms)
+{
+	struct can_publisher *pub;
+
+	if (max_links < 1 || interval_ms == 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	pub = calloc(1, sizeof(*pub));
+	if (pub == NULL) {
+		perror("Cannot allocate snapshot publisher");
+		return NULL;
+	}
+
+	pub->max_links = max_links;
+	pub->interval_us = (__u64)interval_ms * 1000;
+	pub->shm = MAP_FAILED;
+	pub->shm_fd = -1;
+	pub->shm_name = strdup(shm_name);
+	pub->slot_ifindex = calloc(max_links, sizeof(*pub->slot_ifindex));
+	pub->slot_seen = calloc(max_links, sizeof(*pub->slot_seen));
+	if (pub->shm_name == NULL || pub->slot_ifindex == NULL ||
+	    pub->slot_seen == NULL) {
+		perror("Cannot allocate snapshot publisher");
+		goto err;
+	}
+
+	pub->size = sizeof(*pub->shm) + max_links * sizeof(struct shm_slot);
+
+	/*
+	 * Resizing the object of a previous publisher would fault its readers
+	 * beyond the new end, start with a fresh one.
+	 */
+	if (shm_claim(shm_name) < 0)
+		goto err;
+
+	pub->shm_fd = shm_open(shm_name, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (pub->shm_fd < 0) {
+		perror("Cannot open shared memory");
+		goto err;
+	}
+
+	if (flock(pub->shm_fd, LOCK_EX | LOCK_NB) < 0) {
+		perror("Cannot lock shared memory");
+		goto err;
+	}
+
+	if (ftruncate(pub->shm_fd, pub->size) < 0) {
+		perror("Cannot size shared memory");
+		goto err;
+	}
+
+	pub->shm = mmap(NULL, pub->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			pub->shm_fd, 0);
+	if (pub->shm == MAP_FAILED) {
+		perror("Cannot map shared memory");
+		goto err;
+	}
+
+	pub->shm->version = SHM_VERSION;
+	pub->shm->slot_size = sizeof(struct shm_slot);
+	pub->shm->max_links = max_links;
+	__atomic_store_n(&pub->shm->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+
+	pub->h = can_handle_open();
+	if (pub->h == NULL)
+		goto err;
+
+	pub->mon = can_monitor_open(publisher_link_event, pub);
+	if (pub->mon == NULL)
+		goto err;
+
+	/* the monitor learned the links silently, publish them */
+	if (publisher_refresh(pub) < 0)
+		goto err;
+
+	pub->due_us = monotonic_us() + pub->interval_us;
+
+	return pub;
+
+err:
+	can_publisher_close(pub);
+	return NULL;
+}
+
+/**
+ * @ingroup extern
+ * can_publisher_close - close a snapshot publisher
+ *
+ * @param pub snapshot publisher as returned by can_publisher_open, may be
+ * NULL
+ *
+ * The shared memory object is removed, unless its name has been taken over
+ * by another object meanwhile. Readers which have it open still see the last
+ * snapshots, can_reader_age_ms tells them it is no longer updated.
+ */
+void can_publisher_close(struct can_publisher *pub)
+{
+	if (pub == NULL)
+		return;
+
+	can_monitor_close(pub->mon);
+	can_handle_close(pub->h);
+	if (pub->shm != MAP_FAILED)
+		munmap(pub->shm, pub->size);
+	if (pub->shm_fd >= 0) {
+		if (shm_owned(pub))
+			shm_unlink(pub->shm_name);
+		close(pub->shm_fd);	/* releases the lock */
+	}
+	free(pub->shm_name);
+	free(pub->slot_ifindex);
+	free(pub->slot_seen);
+	free(pub);
+}
+
+/**
+ * @ingroup extern
+ * can_publisher_fd - get the pollable file descriptor of a publisher
+ *
+ * @param pub snapshot publisher as returned by can_publisher_open
+ *
+ * @return file descriptor
+ */
+int can_publisher_fd(struct can_publisher *pub)
+{
+	return can_monitor_fd(pub->mon);
+}
+
+/**
+ * @ingroup extern
+ * can_publisher_timeout - get the time until the next refresh is due
+ *
+ * @param pub snapshot publisher as returned by can_publisher_open
+ *
+ * @return milliseconds until the next refresh, 0 if one is due
+ */
+int can_publisher_timeout(struct can_publisher *pub)
+{
+	__u64 now = monotonic_us();
+
+	if (pub->due_us <= now)
+		return 0;
+
+	/* round up, poll must not return before the refresh is due */
+	return (pub->due_us - now + 999) / 1000;
+}
+
+/**
+ * @ingroup extern
+ * can_publisher_dispatch - publish pending notifications and due refreshes
+ *
+ * @param pub snapshot publisher as returned by can_publisher_open
+ *
+ * @return 0 if success
+ * @return -1 if failed
+ */
+int can_publisher_dispatch(struct can_publisher *pub)
+{
+	__u64 now;
+
+	if (can_monitor_dispatch(pub->mon) < 0)
+		return -1;
+
+	now = monotonic_us();
+	if (pub->due_us > now)
+		return 0;
+
+	pub->due_us += pub->interval_us;
+	if (pub->due_us <= now)
+		pub->due_us = now + pub->interval_us;
+
+	return publisher_refresh(pub);
+}
+
+/**
+ * @ingroup extern
+ * can_reader_open - open the snapshots of a publisher
+ *
+ * @param shm_name name of the shared memory object the publisher was opened
+ * with, e.g. CAN_PUBLISH_DEFAULT
+ *
+ * The snapshots are read from shared memory without locks and without
+ * system calls, so readers neither talk to the kernel nor wait for the
+ * publisher or for each other.
+ *
+ * @return pointer to the reader if success
+ * @return NULL if failed
+ */
+struct can_reader *can_reader_open(const char *shm_name)
+{
+	const struct shm_region *shm;
+	struct can_reader *r;
+	struct stat st;
+	int fd;
+
+	fd = shm_open(shm_name, O_RDONLY, 0);
+	if (fd < 0) {
+		perror("Cannot open shared memory");
+		return NULL;
+	}
+
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(*shm)) {
+		fprintf(stderr, "Cannot use shared memory, too small\n");
+		close(fd);
+		return NULL;
+	}
+
+	shm = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm == MAP_FAILED) {
+		perror("Cannot map shared memory");
+		return NULL;
+	}
+
+	if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC ||
+	    shm->version != SHM_VERSION ||
+	    shm->slot_size != sizeof(struct shm_slot) ||
+	    sizeof(*shm) + shm->max_links * sizeof(struct shm_slot) >
+	    (size_t)st.st_size) {
+		fprintf(stderr, "Cannot use shared memory, unknown layout\n");
+		munmap((void *)shm, st.st_size);
+		return NULL;
+	}
+
+	r = calloc(1, sizeof(*r));
+	if (r == NULL) {
+		perror("Cannot allocate snapshot reader");
+		munmap((void *)shm, st.st_size);
+		return NULL;
+	}
+
+	r->shm = shm;
+	r->size = st.st_size;
+	r->max_links = shm->max_links;
+
+	return r;
+}
+
+/**
+ * @ingroup extern
+ * can_reader_close - close a snapshot reader
+ *
+ * @param r snapshot reader as returned by can_reader_open, may be NULL
+ */
+void can_reader_close(struct can_reader *r)
+{
+	if (r == NULL)
+		return;
+
+	munmap((void *)r->shm, r->size);
+	free(r);
+}
+
+/**
+ * @ingroup extern
+ * can_reader_get_link_info - get the published snapshot of a link
+ *
+ * @param r snapshot reader as returned by can_reader_open
+ * @param name name of the can device, e.g. "can0"
+ * @param info pointer to the can_link_info struct.
+ *
+ * @return 0 if success
+ * @return -1 if failed, errno is set to ENODEV if the link is not published,
+ * or EAGAIN if a slot was being written all the time and may hold the link,
+ * just try again then
+ */
+int can_reader_get_link_info(struct can_reader *r, const char *name,
+		struct can_link_info *info)
+{
+	int unstable = 0;
+	int i;
+
+	for (i = 0; i < r->max_links; i++) {
+		if (shm_read(&r->shm->slots[i], info) < 0) {
+			unstable = 1;
+			continue;
+		}
+		if (info->ifindex != 0 && strcmp(info->name, name) == 0)
+			return 0;
+	}
+
+	errno = unstable ? EAGAIN : ENODEV;
+
+	return -1;
+}
+
+/**
+ * @ingroup extern
+ * can_reader_get_all_link_info - get the published snapshots of all links
+ *
+ * @param r snapshot reader as returned by can_reader_open
+ * @param infos array to store the snapshots
+ * @param max number of elements in infos
+ *
+ * @return number of snapshots stored
+ */
+int can_reader_get_all_link_info(struct can_reader *r,
+		struct can_link_info *infos, int max)
+{
+	int i, n = 0;
+
+	for (i = 0; i < r->max_links && n < max; i++) {
+		if (shm_read(&r->shm->slots[i], &infos[n]) < 0)
+			continue;
+		if (infos[n].ifindex != 0)
+			n++;
+	}
+
+	return n;
+}
+
+/**
+ * @ingroup extern
+ * can_reader_age_ms - get the time since the publisher updated the snapshots
+ *
+ * @param r snapshot reader as returned by can_reader_open
+ *
+ * A running publisher updates at least every refresh interval. An older
+ * update means the publisher is gone or stuck.
+ *
+ * @return milliseconds since the last update
+ */
+int can_reader_age_ms(struct can_reader *r)
+{
+	__u64 update = __atomic_load_n(&r->shm->update_us, __ATOMIC_ACQUIRE);
+
+	return (monotonic_us() - update) / 1000;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_fd - get the file descriptor of a netlink handle
+ *
+ * @param h netlink handle as returned by can_handle_open
+ *
+ * The descriptor becomes readable when replies to requests of the async API
+ * (can_async_*) are pending. Add it to your poll/select/epoll loop and call
+ * can_handle_dispatch then.
+ *
+ * Only reading the reply is deferred. rtnetlink carries out a request inside
+ * the sendmsg call of the can_async_* function, under the RTNL lock, and
+ * this includes the open and bit-timing code of the driver for a
+ * modification. So a slow driver still blocks the submitting thread for as
+ * long as the request takes, and so does another task holding the RTNL
+ * lock. Submit slow modifications from a thread of its own if the loop must
+ * not stall.
+ *
+ * @return file descriptor
+ */
+int can_handle_fd(struct can_handle *h)
+{
+	return h->fd;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_dispatch - complete outstanding async requests
+ *
+ * @param h netlink handle as returned by can_handle_open
+ *
+ * This reads all pending replies without blocking and invokes the completion
+ * callback of every request they finish. Requests are matched to replies by
+ * their netlink sequence number, which is also the value the can_async_*
+ * functions return.
+ *
+ * Synchronous calls on the same handle complete async requests on the way if
+ * their replies arrive first.
  *
- * @return 0 if success
+ * @return number of requests completed if success
  * @return -1 if failed
  */
-static int do_set_nl_link(int fd, __u8 if_state, const char *name,
-			  struct req_info *req_info)
+int can_handle_dispatch(struct can_handle *h)
 {
-	struct set_req req;
-
-	const char *type = "can";
-
-	memset(&req, 0, sizeof(req));
-
-	req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
-	req.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
-	req.n.nlmsg_type = RTM_NEWLINK;
-	req.i.ifi_family = 0;
+	struct rx_buf tmp, *rx;
+	struct nlmsghdr *nl_msg;
+	ssize_t msglen;
+	int completed = 0;
 
-	req.i.ifi_index = if_nametoindex(name);
-	if (req.i.ifi_index == 0) {
-		fprintf(stderr, "Cannot find device \"%s\"\n", name);
-		return -1;
-	}
+	rx = rx_begin(h, &tmp);
+	while (1) {
+		size_t u_msglen;
 
-	if (if_state) {
-		switch (if_state) {
-		case IF_DOWN:
-			req.i.ifi_change |= IFF_UP;
-			req.i.ifi_flags &= ~IFF_UP;
-			break;
-		case IF_UP:
-			req.i.ifi_change |= IFF_UP;
-			req.i.ifi_flags |= IFF_UP;
+		msglen = rx_recv(h->fd, rx, MSG_DONTWAIT);
+		if (msglen < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			if (errno == ENOBUFS) {
+				rx_overrun(h);
+				continue;
+			}
+			perror("Cannot receive netlink reply");
+			completed = -1;
 			break;
-		default:
-			fprintf(stderr, "unknown state\n");
-			return -1;
 		}
-	}
-
-	if (req_info != NULL) {
-		/* setup linkinfo section */
-		struct rtattr *linkinfo = NLMSG_TAIL(&req.n);
-		addattr_l(&req.n, sizeof(req), IFLA_LINKINFO, NULL, 0);
-		addattr_l(&req.n, sizeof(req), IFLA_INFO_KIND, type,
-			  strlen(type));
-		/* setup data section */
-		struct rtattr *data = NLMSG_TAIL(&req.n);
-		addattr_l(&req.n, sizeof(req), IFLA_INFO_DATA, NULL, 0);
 
-		if (req_info->restart_ms > 0 || req_info->disable_autorestart)
-			addattr32(&req.n, 1024, IFLA_CAN_RESTART_MS,
-				  req_info->restart_ms);
+		u_msglen = (size_t) msglen;
+		for (nl_msg = (struct nlmsghdr *)rx->buf;
+		     NLMSG_OK(nl_msg, u_msglen);
+		     nl_msg = NLMSG_NEXT(nl_msg, u_msglen))
+			completed += async_process_msg(h, nl_msg);
+	}
+	rx_end(h, rx);
 
-		if (req_info->restart)
-			addattr32(&req.n, 1024, IFLA_CAN_RESTART, 1);
+	return completed;
+}
 
-		if (req_info->bittiming != NULL) {
-			addattr_l(&req.n, 1024, IFLA_CAN_BITTIMING,
-				  req_info->bittiming,
-				  sizeof(struct can_bittiming));
-		}
+/**
+ * @ingroup extern
+ * can_handle_pending - get the number of outstanding async requests
+ *
+ * @param h netlink handle as returned by can_handle_open
+ *
+ * @return number of requests which have not been completed yet
+ */
+int can_handle_pending(struct can_handle *h)
+{
+	struct async_req *req;
+	int n = 0;
 
-		if (req_info->dbittiming != NULL) {
-			addattr_l(&req.n, 1024, IFLA_CAN_DATA_BITTIMING,
-				  req_info->dbittiming,
-				  sizeof(struct can_bittiming));
-		}
+	for (req = h->pending; req != NULL; req = req->next)
+		n++;
 
-		if (req_info->ctrlmode != NULL) {
-			addattr_l(&req.n, 1024, IFLA_CAN_CTRLMODE,
-				  req_info->ctrlmode,
-				  sizeof(struct can_ctrlmode));
-		}
+	return n;
+}
 
-		/* mark end of data section */
-		data->rta_len = (void *)NLMSG_TAIL(&req.n) - (void *)data;
+/**
+ * @ingroup extern
+ * can_async_get_link_info - submit a can_get_link_info request
+ *
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
+ * @param cb completion callback, gets the snapshot of the link
+ * @param data user pointer passed to cb
+ *
+ * This sends the request and returns without reading the reply, see
+ * can_handle_fd for what the kernel does before the send returns. cb is
+ * invoked from can_handle_dispatch once the reply arrived.
+ *
+ * @return sequence number of the request if success
+ * @return -1 if failed
+ */
+int can_async_get_link_info(struct can_handle *h, const char *name,
+		can_async_cb cb, void *data)
+{
+	__u32 seq = next_seq(h);
 
-		/* mark end of link info section */
-		linkinfo->rta_len =
-		    (void *)NLMSG_TAIL(&req.n) - (void *)linkinfo;
+	if (send_dump_request(h, name, 0, AF_PACKET, RTM_GETLINK, seq, 0) < 0) {
+		perror("Cannot send dump request");
+		return -1;
 	}
 
-	return send_mod_request(fd, &req.n);
+	return async_add(h, seq, 1, cb, data);
 }
 
 /**
- * @ingroup intern
- * @brief set_link - open a netlink socket and setup linkinfo
+ * @ingroup extern
+ * can_async_do_restart - submit a restart request
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a
- * shows in your system. usually it contains prefix "can" and the numer of the
- * can line. e.g. "can0"
- * @param if_state state of the interface we want to put the device into. this
- * parameter is only set if you want to use the callback to driver up/down the
- * device
- * @param req_info request parameters
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
+ * @param cb completion callback
+ * @param data user pointer passed to cb
  *
- * This is a wrapper for do_set_nl_link. It opens a netlink socket and sends
- * down the requests.
+ * Unlike can_do_restart this does not check the state and restart_ms of the
+ * device first. The kernel rejects the request if the device is not in
+ * BUS_OFF or auto restart is turned on.
  *
- * @return 0 if success
+ * @return sequence number of the request if success
  * @return -1 if failed
  */
-static int set_link(const char *name, __u8 if_state, struct req_info *req_info)
+int can_async_do_restart(struct can_handle *h, const char *name,
+		can_async_cb cb, void *data)
 {
-	int err, fd;
-
-	fd = open_nl_sock();
-	if (fd < 0)
-		return -1;
-
-	err = do_set_nl_link(fd, if_state, name, req_info);
-	close(fd);
+	struct req_info req_info = {
+		.restart = 1,
+	};
 
-	return err;
+	return async_set_link(h, name, 0, &req_info, cb, data);
 }
 
 /**
  * @ingroup extern
- * can_do_start - start the can interface
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
+ * can_async_do_stop - submit a can_do_stop request
  *
- * This starts the can interface with the given name. It simply changes the if
- * state of the interface to up. All initialisation works will be done in
- * kernel. The if state can also be queried by a simple ifconfig.
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
+ * @param cb completion callback
+ * @param data user pointer passed to cb
  *
- * @return 0 if success
+ * @return sequence number of the request if success
  * @return -1 if failed
  */
-int can_do_start(const char *name)
+int can_async_do_stop(struct can_handle *h, const char *name,
+		can_async_cb cb, void *data)
 {
-	return set_link(name, IF_UP, NULL);
+	return async_set_link(h, name, IF_DOWN, NULL, cb, data);
 }
 
 /**
  * @ingroup extern
- * can_do_stop - stop the can interface
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
+ * can_async_do_start - submit a can_do_start request
  *
- * This stops the can interface with the given name. It simply changes the if
- * state of the interface to down. Any running communication would be stopped.
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
+ * @param cb completion callback
+ * @param data user pointer passed to cb
  *
- * @return 0 if success
+ * The driver opens the device before this returns, see can_handle_fd.
+ *
+ * @return sequence number of the request if success
  * @return -1 if failed
  */
-int can_do_stop(const char *name)
+int can_async_do_start(struct can_handle *h, const char *name,
+		can_async_cb cb, void *data)
 {
-	return set_link(name, IF_DOWN, NULL);
+	return async_set_link(h, name, IF_UP, NULL, cb, data);
 }
 
 /**
  * @ingroup extern
- * can_do_restart - restart the can interface
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- *
- * This triggers the start mode of the can device.
+ * can_async_set_restart_ms - submit a can_set_restart_ms request
  *
- * NOTE:
- * - restart mode can only be triggerd if the device is in BUS_OFF and the auto
- * restart not turned on (restart_ms == 0)
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
+ * @param restart_ms interval of auto restart in milliseconds
+ * @param cb completion callback
+ * @param data user pointer passed to cb
  *
- * @return 0 if success
+ * @return sequence number of the request if success
  * @return -1 if failed
  */
-int can_do_restart(const char *name)
+int can_async_set_restart_ms(struct can_handle *h, const char *name,
+		__u32 restart_ms, can_async_cb cb, void *data)
 {
-	int state;
-	__u32 restart_ms;
+	struct req_info req_info = {
+		.restart_ms = restart_ms,
+	};
 
-	/* first we check if we can restart the device at all */
-	if ((can_get_state(name, &state)) < 0) {
-		fprintf(stderr, "cannot get bustate, "
-			"something is seriously wrong\n");
-		return -1;
-	} else if (state != CAN_STATE_BUS_OFF) {
-		fprintf(stderr,
-			"Device is not in BUS_OFF," " no use to restart\n");
-		return -1;
-	}
+	if (restart_ms == 0)
+		req_info.disable_autorestart = 1;
 
-	if ((can_get_restart_ms(name, &restart_ms)) < 0) {
-		fprintf(stderr, "cannot get restart_ms, "
-			"something is seriously wrong\n");
-		return -1;
-	} else if (restart_ms > 0) {
-		fprintf(stderr,
-			"auto restart with %ums interval is turned on,"
-			" no use to restart\n", restart_ms);
-		return -1;
-	}
+	return async_set_link(h, name, 0, &req_info, cb, data);
+}
 
+/**
+ * @ingroup extern
+ * can_async_set_bittiming - submit a can_set_bittiming request
+ *
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
+ * @param bt pointer to a can_bittiming struct
+ * @param cb completion callback
+ * @param data user pointer passed to cb
+ *
+ * @return sequence number of the request if success
+ * @return -1 if failed
+ */
+int can_async_set_bittiming(struct can_handle *h, const char *name,
+		struct can_bittiming *bt, can_async_cb cb, void *data)
+{
 	struct req_info req_info = {
-		.restart = 1,
+		.bittiming = bt,
 	};
 
-	return set_link(name, 0, &req_info);
+	return async_set_link(h, name, 0, &req_info, cb, data);
 }
 
 /**
  * @ingroup extern
- * can_set_restart_ms - set interval of auto restart.
- *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param restart_ms interval of auto restart in milliseconds
+ * can_async_set_canfd_bittiming - submit a can_set_canfd_bittiming request
  *
- * This sets how often the device shall automatically restart the interface in
- * case that a bus_off is detected.
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
+ * @param bt pointer to the nominal can_bittiming struct
+ * @param dbt pointer to the data can_bittiming struct
+ * @param cb completion callback
+ * @param data user pointer passed to cb
  *
- * @return 0 if success
+ * @return sequence number of the request if success
  * @return -1 if failed
  */
-int can_set_restart_ms(const char *name, __u32 restart_ms)
+int can_async_set_canfd_bittiming(struct can_handle *h, const char *name,
+		struct can_bittiming *bt, struct can_bittiming *dbt,
+		can_async_cb cb, void *data)
 {
+	struct can_ctrlmode ctrl = {
+		.mask = CAN_CTRLMODE_FD,
+		.flags = CAN_CTRLMODE_FD,
+	};
 	struct req_info req_info = {
-		.restart_ms = restart_ms,
+		.bittiming = bt,
+		.dbittiming = dbt,
+		.ctrlmode = &ctrl
 	};
 
-	if (restart_ms == 0)
-		req_info.disable_autorestart = 1;
-
-	return set_link(name, 0, &req_info);
+	return async_set_link(h, name, 0, &req_info, cb, data);
 }
 
 /**
  * @ingroup extern
- * can_set_ctrlmode - setup the control mode.
- *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
+ * can_async_set_ctrlmode - submit a can_set_ctrlmode request
  *
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
  * @param cm pointer of a can_ctrlmode struct
+ * @param cb completion callback
+ * @param data user pointer passed to cb
  *
- * This sets the control mode of the can device. There are currently the
- * following modes available (each mapped to its own macro):
- *
- * @code
- * #define CAN_CTRLMODE_LOOPBACK           0x01    // Loopback mode
- * #define CAN_CTRLMODE_LISTENONLY         0x02    // Listen-only mode
- * #define CAN_CTRLMODE_3_SAMPLES          0x04    // Triple sampling mode
- * #define CAN_CTRLMODE_ONE_SHOT           0x08    // One-Shot mode
- * #define CAN_CTRLMODE_BERR_REPORTING     0x10    // Bus-error reporting
- * #define CAN_CTRLMODE_FD                 0x20    // CAN FD mode
- * #define CAN_CTRLMODE_PRESUME_ACK        0x40    // Ignore missing CAN ACKs
- * @endcode
+ * @return sequence number of the request if success
+ * @return -1 if failed
+ */
+int can_async_set_ctrlmode(struct can_handle *h, const char *name,
+		struct can_ctrlmode *cm, can_async_cb cb, void *data)
+{
+	struct req_info req_info = {
+		.ctrlmode = cm,
+	};
+
+	return async_set_link(h, name, 0, &req_info, cb, data);
+}
+
+/**
+ * @ingroup extern
+ * can_batch_new - create an empty batch of modification requests
  *
- * You have to define the control mode struct yourself. A can_ctrlmode struct
- * is declared as:
+ * A batch collects configuration changes for any number of interfaces with
+ * the can_batch_* functions. can_batch_send then sends them back to back,
+ * several requests per sendmsg, and collects the acks afterwards, instead of
+ * waiting for the ack of every request before sending the next one:
  *
  * @code
- * struct can_ctrlmode {
- *	__u32 mask;
- *	__u32 flags;
+ * struct can_batch *b = can_batch_new();
+ *
+ * for (i = 0; i < n; i++) {
+ *	can_batch_set_bitrate(b, names[i], 500000);
+ *	can_batch_set_restart_ms(b, names[i], 100);
+ *	can_batch_do_start(b, names[i]);
  * }
+ * if (can_batch_send(h, b) != 0)
+ *	for (i = 0; i < can_batch_count(b); i++)
+ *		if (can_batch_result(b, i) < 0)
+ *			...
+ * can_batch_free(b);
  * @endcode
  *
- * You can use mask to select modes you want to control and flags to determine
- * if you want to turn the selected mode(s) on or off. E. g. the following
- * pseudocode will turn the loopback mode on and listenonly mode off:
+ * The requests are processed by the kernel in the order they were added.
+ *
+ * @return pointer to the batch if success
+ * @return NULL if failed
+ */
+struct can_batch *can_batch_new(void)
+{
+	struct can_batch *b;
+
+	b = calloc(1, sizeof(*b));
+	if (b == NULL)
+		perror("Cannot allocate batch");
+
+	return b;
+}
+
+/**
+ * @ingroup extern
+ * can_batch_free - free a batch
+ *
+ * @param b batch as returned by can_batch_new, may be NULL
+ */
+void can_batch_free(struct can_batch *b)
+{
+	if (b == NULL)
+		return;
+
+	free(b->entries);
+	free(b);
+}
+
+/**
+ * @ingroup extern
+ * can_batch_count - get the number of requests in a batch
+ *
+ * @param b batch as returned by can_batch_new
+ *
+ * @return number of requests
+ */
+int can_batch_count(struct can_batch *b)
+{
+	return b->n;
+}
+
+/**
+ * @ingroup intern
+ * @brief batch_add - add a linkinfo modification request to a batch
+ *
+ * @param b batch
+ * @param name name of the can device, e.g. "can0"
+ * @param if_state state of the interface we want to put the device into
+ * @param req_info request parameters
+ *
+ * @return index of the request in the batch if success
+ * @return -1 if failed
+ */
+static int batch_add(struct can_batch *b, const char *name, __u8 if_state,
+		     struct req_info *req_info)
+{
+	struct batch_entry *e;
+
+	if (b->n == b->alloc) {
+		int alloc = b->alloc ? b->alloc * 2 : 16;
+		struct batch_entry *entries;
+
+		entries = realloc(b->entries, alloc * sizeof(*entries));
+		if (entries == NULL) {
+			perror("Cannot grow batch");
+			return -1;
+		}
+		b->entries = entries;
+		b->alloc = alloc;
+	}
+
+	e = &b->entries[b->n];
+	if (build_set_req(&e->req, if_state, name, 0, req_info) < 0)
+		return -1;
+
+	e->req.n.nlmsg_flags |= NLM_F_ACK;
+	e->err = 1;	/* not sent yet */
+
+	return b->n++;
+}
+
+/**
+ * @ingroup extern
+ * can_batch_do_stop - add a can_do_stop request to a batch
+ *
+ * @param b batch as returned by can_batch_new
+ * @param name name of the can device, e.g. "can0"
  *
- * @code
- * struct can_ctrlmode cm;
- * memset(&cm, 0, sizeof(cm));
- * cm.mask = CAN_CTRLMODE_LOOPBACK | CAN_CTRLMODE_LISTENONLY;
- * cm.flags = CAN_CTRLMODE_LOOPBACK;
- * can_set_ctrlmode(candev, &cm);
- * @endcode
+ * @return index of the request in the batch if success
+ * @return -1 if failed
+ */
+int can_batch_do_stop(struct can_batch *b, const char *name)
+{
+	return batch_add(b, name, IF_DOWN, NULL);
+}
+
+/**
+ * @ingroup extern
+ * can_batch_do_start - add a can_do_start request to a batch
  *
- * @return 0 if success
+ * @param b batch as returned by can_batch_new
+ * @param name name of the can device, e.g. "can0"
+ *
+ * @return index of the request in the batch if success
  * @return -1 if failed
  */
+int can_batch_do_start(struct can_batch *b, const char *name)
+{
+	return batch_add(b, name, IF_UP, NULL);
+}
 
-int can_set_ctrlmode(const char *name, struct can_ctrlmode *cm)
+/**
+ * @ingroup extern
+ * can_batch_set_restart_ms - add a can_set_restart_ms request to a batch
+ *
+ * @param b batch as returned by can_batch_new
+ * @param name name of the can device, e.g. "can0"
+ * @param restart_ms interval of auto restart in milliseconds
+ *
+ * @return index of the request in the batch if success
+ * @return -1 if failed
+ */
+int can_batch_set_restart_ms(struct can_batch *b, const char *name,
+		__u32 restart_ms)
 {
 	struct req_info req_info = {
-		.ctrlmode = cm,
+		.restart_ms = restart_ms,
 	};
 
-	return set_link(name, 0, &req_info);
+	if (restart_ms == 0)
+		req_info.disable_autorestart = 1;
+
+	return batch_add(b, name, 0, &req_info);
 }
 
 /**
  * @ingroup extern
- * can_set_bittiming - setup the bittiming.
+ * can_batch_set_bittiming - add a can_set_bittiming request to a batch
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
+ * @param b batch as returned by can_batch_new
+ * @param name name of the can device, e.g. "can0"
  * @param bt pointer to a can_bittiming struct
  *
- * This sets the bittiming of the can device. This is for advantage usage. In
- * normal cases you should use can_set_bitrate to simply define the bitrate and
- * let the driver automatically calculate the bittiming. You will only need this
- * function if you wish to define the bittiming in expert mode with fully
- * manually defined timing values.
- * You have to define the bittiming struct yourself. a can_bittiming struct
- * consists of:
- *
- * @code
- * struct can_bittiming {
- *	__u32 bitrate;
- *	__u32 sample_point;
- *	__u32 tq;
- *	__u32 prop_seg;
- *	__u32 phase_seg1;
- *	__u32 phase_seg2;
- *	__u32 sjw;
- *	__u32 brp;
- * }
- * @endcode
- *
- * to define a customized bittiming, you have to define tq, prop_seq,
- * phase_seg1, phase_seg2 and sjw. See http://www.can-cia.org/index.php?id=88
- * for more information about bittiming and synchronizations on can bus.
- *
- * @return 0 if success
+ * @return index of the request in the batch if success
  * @return -1 if failed
  */
-
-int can_set_bittiming(const char *name, struct can_bittiming *bt)
+int can_batch_set_bittiming(struct can_batch *b, const char *name,
+		struct can_bittiming *bt)
 {
 	struct req_info req_info = {
 		.bittiming = bt,
 	};
 
-	return set_link(name, 0, &req_info);
+	return batch_add(b, name, 0, &req_info);
 }
 
 /**
  * @ingroup extern
- * can_set_data_bittiming - setup the bittiming for CAN FD Data transmission.
- *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param bt pointer to a can_bittiming struct
- *
- * This sets the bittiming of the can device for the data transmission if CAN FD is enabled. This is for advantage usage. In
- * normal cases you should use can_set_bitrate to simply define the bitrate and
- * let the driver automatically calculate the bittiming. You will only need this
- * function if you wish to define the bittiming in expert mode with fully
- * manually defined timing values.
- * You have to define the bittiming struct yourself. a can_bittiming struct
- * consists of:
- *
- * @code
- * struct can_bittiming {
- *	__u32 bitrate;
- *	__u32 sample_point;
- *	__u32 tq;
- *	__u32 prop_seg;
- *	__u32 phase_seg1;
- *	__u32 phase_seg2;
- *	__u32 sjw;
- *	__u32 brp;
- * }
- * @endcode
+ * can_batch_set_canfd_bittiming - add a can_set_canfd_bittiming request to a
+ * batch
  *
- * to define a customized bittiming, you have to define tq, prop_seq,
- * phase_seg1, phase_seg2 and sjw. See http://www.can-cia.org/index.php?id=88
- * for more information about bittiming and synchronizations on can bus.
+ * @param b batch as returned by can_batch_new
+ * @param name name of the can device, e.g. "can0"
+ * @param bt pointer to the nominal can_bittiming struct
+ * @param dbt pointer to the data can_bittiming struct
  *
- * @return 0 if success
+ * @return index of the request in the batch if success
  * @return -1 if failed
  */
-
-int can_set_canfd_bittiming(const char *name, struct can_bittiming *bt, struct can_bittiming *dbt)
+int can_batch_set_canfd_bittiming(struct can_batch *b, const char *name,
+		struct can_bittiming *bt, struct can_bittiming *dbt)
 {
 	struct can_ctrlmode ctrl = {
 		.mask = CAN_CTRLMODE_FD,
@@ -994,388 +7494,843 @@ int can_set_canfd_bittiming(const char *name, struct can_bittiming *bt, struct c
 		.ctrlmode = &ctrl
 	};
 
-	return set_link(name, 0, &req_info);
+	return batch_add(b, name, 0, &req_info);
 }
 
 /**
  * @ingroup extern
- * can_set_bitrate - setup the bitrate.
- *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param bitrate bitrate of the can bus
+ * can_batch_set_ctrlmode - add a can_set_ctrlmode request to a batch
  *
- * This is the recommended way to setup the bus bit timing. You only have to
- * give a bitrate value here. The exact bit timing will be calculated
- * automatically. To use this function, make sure that CONFIG_CAN_CALC_BITTIMING
- * is set to y in your kernel configuration. bitrate can be a value between
- * 1000(1kbit/s) and 1000000(1000kbit/s).
+ * @param b batch as returned by can_batch_new
+ * @param name name of the can device, e.g. "can0"
+ * @param cm pointer of a can_ctrlmode struct
  *
- * @return 0 if success
+ * @return index of the request in the batch if success
  * @return -1 if failed
  */
-
-int can_set_bitrate(const char *name, __u32 bitrate)
+int can_batch_set_ctrlmode(struct can_batch *b, const char *name,
+		struct can_ctrlmode *cm)
 {
-	struct can_bittiming bt;
-
-	memset(&bt, 0, sizeof(bt));
-	bt.bitrate = bitrate;
+	struct req_info req_info = {
+		.ctrlmode = cm,
+	};
 
-	return can_set_bittiming(name, &bt);
+	return batch_add(b, name, 0, &req_info);
 }
 
 /**
  * @ingroup extern
- * can_set_bitrate_samplepoint - setup the bitrate.
+ * can_batch_set_bitrate - add a can_set_bitrate request to a batch
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
+ * @param b batch as returned by can_batch_new
+ * @param name name of the can device, e.g. "can0"
  * @param bitrate bitrate of the can bus
- * @param sample_point sample point value
- *
- * This one is similar to can_set_bitrate, only you can additionally set up the
- * time point for sampling (sample point) customly instead of using the
- * CIA recommended value. sample_point can be a value between 0 and 999.
  *
- * @return 0 if success
+ * @return index of the request in the batch if success
  * @return -1 if failed
  */
-int can_set_bitrate_samplepoint(const char *name, __u32 bitrate,
-				__u32 sample_point)
+int can_batch_set_bitrate(struct can_batch *b, const char *name,
+		__u32 bitrate)
 {
 	struct can_bittiming bt;
 
 	memset(&bt, 0, sizeof(bt));
 	bt.bitrate = bitrate;
-	bt.sample_point = sample_point;
 
-	return can_set_bittiming(name, &bt);
+	return can_batch_set_bittiming(b, name, &bt);
 }
 
 /**
- * @ingroup extern
- * can_set_canfd_bitrates_samplepoint - setup the bitrate.
- *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param bitrate bitrate of the can bus
- * @param sample_point sample point value
- * @param dbitrate dbitrate of the can bus
- * @param dsample_point dsample point value
+ * @ingroup intern
+ * @brief batch_send_chunk - send requests of a batch in a single sendmsg
  *
- * This one is similar to can_set_bitrate, only you can additionally set up the
- * time point for sampling (sample point) customly instead of using the
- * CIA recommended value. sample_point can be a value between 0 and 999.
+ * @param h handle to a priorly opened netlink socket
+ * @param e first request to send
+ * @param n number of requests to send, at most BATCH_CHUNK
  *
- * @return 0 if success
+ * @return 0 if the status of all requests was received
  * @return -1 if failed
  */
-int can_set_canfd_bitrates_samplepoint(const char *name, __u32 bitrate,
-				__u32 sample_point, __u32 dbitrate, __u32 dsample_point)
+static int batch_send_chunk(struct can_handle *h, struct batch_entry *e, int n)
 {
-	struct can_bittiming bt;
-	struct can_bittiming dbt;
+	struct sockaddr_nl nladdr;
+	struct iovec iov[BATCH_CHUNK];
+	struct msghdr msg = {
+		.msg_name = &nladdr,
+		.msg_namelen = sizeof(nladdr),
+		.msg_iov = iov,
+		.msg_iovlen = n,
+	};
+	__u32 seqs[BATCH_CHUNK];
+	int errs[BATCH_CHUNK];
+	int i;
 
-	memset(&bt, 0, sizeof(bt));
-	bt.bitrate = bitrate;
-	bt.sample_point = sample_point;
+	memset(&nladdr, 0, sizeof(nladdr));
+	nladdr.nl_family = AF_NETLINK;
 
-	memset(&dbt, 0, sizeof(dbt));
-	dbt.bitrate = dbitrate;
-	dbt.sample_point = dsample_point;
+	for (i = 0; i < n; i++) {
+		e[i].req.n.nlmsg_seq = seqs[i] = next_seq(h);
+		iov[i].iov_base = &e[i].req;
+		iov[i].iov_len = NLMSG_ALIGN(e[i].req.n.nlmsg_len);
+	}
+
+	if (sendmsg(h->fd, &msg, 0) < 0) {
+		perror("Cannot talk to rtnetlink");
+		return -1;
+	}
+	coalesce_invalidate(h);
+
+	if (wait_acks(h, seqs, errs, n) < 0)
+		return -1;
+
+	for (i = 0; i < n; i++)
+		e[i].err = errs[i];
 
-	return can_set_canfd_bittiming(name, &bt, &dbt);
+	return 0;
 }
 
 /**
  * @ingroup extern
- * can_get_state - get the current state of the device
+ * can_batch_send - send all requests of a batch
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param state pointer to store the state
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
+ * @param b batch as returned by can_batch_new
  *
- * This one stores the current state of the can interface into the given
- * pointer. Valid states are:
- * - CAN_STATE_ERROR_ACTIVE
- * - CAN_STATE_ERROR_WARNING
- * - CAN_STATE_ERROR_PASSIVE
- * - CAN_STATE_BUS_OFF
- * - CAN_STATE_STOPPED
- * - CAN_STATE_SLEEPING
+ * This sends the requests of the batch back to back and collects the acks
+ * by their sequence number. The kernel processes every request even if an
+ * earlier one failed. The status of each request can be read with
+ * can_batch_result afterwards.
  *
- * The first four states is determined by the value of RX/TX error counter.
- * Please see relevant can specification for more information about this. A
- * device in STATE_STOPPED is an inactive device. STATE_SLEEPING is not
- * implemented on all devices.
+ * @return number of failed requests, 0 if all succeeded
+ * @return -1 if the requests could not be sent or the acks not be received
+ */
+int can_batch_send(struct can_handle *h, struct can_batch *b)
+{
+	struct can_handle *tmp = NULL;
+	int failed = 0;
+	int i, n;
+
+	if (h == NULL) {
+		h = tmp = tmp_handle_get();
+		if (h == NULL)
+			return -1;
+	}
+
+	for (i = 0; i < b->n; i += n) {
+		n = b->n - i;
+		if (n > BATCH_CHUNK)
+			n = BATCH_CHUNK;
+
+		if (batch_send_chunk(h, &b->entries[i], n) < 0) {
+			failed = -1;
+			break;
+		}
+	}
+
+	tmp_handle_put(tmp);
+
+	if (failed < 0) {
+		for (; i < b->n; i++)
+			b->entries[i].err = -EIO;
+		return -1;
+	}
+
+	for (i = 0; i < b->n; i++)
+		if (b->entries[i].err)
+			failed++;
+
+	return failed;
+}
+
+/**
+ * @ingroup extern
+ * can_batch_result - get the status of a request of a sent batch
  *
- * @return 0 if success
- * @return -1 if failed
+ * @param b batch as returned by can_batch_new
+ * @param index index of the request as returned when it was added
+ *
+ * @return 0 if the request succeeded
+ * @return negative errno value if the request failed
  */
+int can_batch_result(struct can_batch *b, int index)
+{
+	if (index < 0 || index >= b->n)
+		return -EINVAL;
 
-int can_get_state(const char *name, int *state)
+	if (b->entries[index].err > 0)
+		return -EAGAIN;	/* not sent yet */
+
+	return b->entries[index].err;
+}
+
+/**
+ * @ingroup intern
+ * @brief prepare - encode a linkinfo modification request for later use
+ *
+ * @param h handle to a priorly opened netlink socket
+ * @param name name of the can device, e.g. "can0"
+ * @param if_state state of the interface we want to put the device into
+ * @param req_info request parameters
+ *
+ * The name is resolved now, the request addresses the device by index.
+ *
+ * @return pointer to the prepared request if success
+ * @return NULL if failed
+ */
+static struct can_prepared *prepare(struct can_handle *h, const char *name,
+				    __u8 if_state, struct req_info *req_info)
 {
-	return get_link(name, GET_STATE, state);
+	struct can_prepared *p;
+	struct set_req req;
+	int ifindex;
+
+	if (h == NULL) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	ifindex = can_handle_name_to_index(h, name);
+	if (ifindex < 0)
+		return NULL;
+
+	if (build_set_req(&req, if_state, NULL, ifindex, req_info) < 0)
+		return NULL;
+
+	p = malloc(sizeof(*p) + req.n.nlmsg_len);
+	if (p == NULL) {
+		perror("Cannot allocate prepared request");
+		return NULL;
+	}
+
+	p->h = h;
+	memcpy(p->n, &req, req.n.nlmsg_len);
+
+	/* have the receive buffer in place for the first execution */
+	if (h->rx.buf == NULL)
+		can_handle_set_rxbuf(h, NULL, RX_BUF_SIZE);
+
+	return p;
 }
 
 /**
  * @ingroup extern
- * can_get_restart_ms - get the current interval of auto restarting.
+ * can_handle_prepare_do_start - prepare a can_do_start request
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param restart_ms pointer to store the value.
+ * @param h netlink handle as returned by can_handle_open
+ * @param name name of the can device, e.g. "can0"
  *
- * This one stores the current interval of auto restarting into the given
- * pointer.
+ * This encodes the request once, so that can_prepared_exec only has to send
+ * it and wait for the status: a single sendmsg and a single reply, without
+ * building the message or resolving the name again. Use it for operations
+ * which are issued repeatedly and need a short and steady latency.
  *
- * The socketcan framework can automatically restart a device if it is in
- * bus_off in a given interval. This function gets this value in milliseconds.
- * restart_ms == 0 means that autorestarting is turned off.
+ * The name is resolved to the interface index when the request is prepared,
+ * renaming the interface later does not matter. The request is executed on
+ * h, which must stay open until the request is freed with
+ * can_prepared_free.
  *
- * @return 0 if success
- * @return -1 if failed
+ * @return pointer to the prepared request if success
+ * @return NULL if failed
+ */
+struct can_prepared *can_handle_prepare_do_start(struct can_handle *h,
+		const char *name)
+{
+	return prepare(h, name, IF_UP, NULL);
+}
+
+/**
+ * @ingroup extern
+ * can_handle_prepare_do_stop - prepare a can_do_stop request
+ *
+ * Please see can_handle_prepare_do_start for the parameters and more
+ * information.
+ *
+ * @return pointer to the prepared request if success
+ * @return NULL if failed
  */
-
-int can_get_restart_ms(const char *name, __u32 *restart_ms)
+struct can_prepared *can_handle_prepare_do_stop(struct can_handle *h,
+		const char *name)
 {
-	return get_link(name, GET_RESTART_MS, restart_ms);
+	return prepare(h, name, IF_DOWN, NULL);
 }
 
 /**
  * @ingroup extern
- * can_get_bittiming - get the current bittimnig configuration.
- *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param bt pointer to the bittiming struct.
+ * can_handle_prepare_do_restart - prepare a can_do_restart request
  *
- * This one stores the current bittiming configuration.
+ * Unlike can_do_restart, the prepared request does not query the state and
+ * restart_ms of the device first. The kernel rejects the restart with EBUSY
+ * if the device is not bus-off, and with EINVAL if restart_ms is set.
  *
- * Please see can_set_bittiming for more information about bit timing.
+ * Please see can_handle_prepare_do_start for the parameters and more
+ * information.
  *
- * @return 0 if success
- * @return -1 if failed
+ * @return pointer to the prepared request if success
+ * @return NULL if failed
  */
-int can_get_bittiming(const char *name, struct can_bittiming *bt)
+struct can_prepared *can_handle_prepare_do_restart(struct can_handle *h,
+		const char *name)
 {
-	return get_link(name, GET_BITTIMING, bt);
+	struct req_info req_info = {
+		.restart = 1,
+	};
+
+	return prepare(h, name, 0, &req_info);
 }
 
 /**
  * @ingroup extern
- * can_get_data_bittiming - get the current bittimnig configuration.
+ * can_handle_prepare_set_ctrlmode - prepare a can_set_ctrlmode request
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param dbt pointer to the bittiming struct.
+ * @param cm pointer of a can_ctrlmode struct, copied into the request
  *
- * This one stores the current bittiming configuration.
+ * To toggle a mode, e.g. listen-only, prepare one request which sets the
+ * flag and one which clears it.
  *
- * Please see can_set_bittiming for more information about bit timing.
+ * Please see can_handle_prepare_do_start for the other parameters and more
+ * information.
  *
- * @return 0 if success
- * @return -1 if failed
+ * @return pointer to the prepared request if success
+ * @return NULL if failed
  */
-int can_get_data_bittiming(const char *name, struct can_bittiming *dbt)
+struct can_prepared *can_handle_prepare_set_ctrlmode(struct can_handle *h,
+		const char *name, struct can_ctrlmode *cm)
 {
-	return get_link(name, GET_DATA_BITTIMING, dbt);
+	struct req_info req_info = {
+		.ctrlmode = cm,
+	};
+
+	return prepare(h, name, 0, &req_info);
 }
 
 /**
  * @ingroup extern
- * can_get_ctrlmode - get the current control mode.
- *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param cm pointer to the ctrlmode struct.
+ * can_prepared_exec - execute a prepared request
  *
- * This one stores the current control mode configuration.
+ * @param p prepared request as returned by one of the can_handle_prepare_*
+ * functions
  *
- * Please see can_set_ctrlmode for more information about control modes.
+ * This sends the request on its handle and waits for the status. A prepared
+ * request can be executed any number of times.
  *
  * @return 0 if success
  * @return -1 if failed
  */
+int can_prepared_exec(struct can_prepared *p)
+{
+	return send_mod_request(p->h, p->n);
+}
 
-int can_get_ctrlmode(const char *name, struct can_ctrlmode *cm)
+/**
+ * @ingroup extern
+ * can_prepared_free - free a prepared request
+ *
+ * @param p prepared request, may be NULL
+ */
+void can_prepared_free(struct can_prepared *p)
 {
-	return get_link(name, GET_CTRLMODE, cm);
+	free(p);
 }
 
 /**
  * @ingroup extern
- * can_get_clock - get the current clock struct.
+ * can_handle_apply_config - can_apply_config using a netlink handle
  *
- * @param name: name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param clock pointer to the clock struct.
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
  *
- * This one stores the current clock configuration. At the time of writing the
- * can_clock struct only contains information about the clock frequecy. This
- * information is e.g. essential while setting up the bit timing.
+ * Please see can_apply_config for the other parameters and more information.
  *
  * @return 0 if success
  * @return -1 if failed
  */
-int can_get_clock(const char *name, struct can_clock *clock)
+int can_handle_apply_config(struct can_handle *h, const char *name,
+		const struct can_config *cfg, int *stage)
 {
-	return get_link(name, GET_CLOCK, clock);
+	struct can_handle *tmp = NULL;
+	struct batch_entry e[2];
+	struct can_bittiming bt, dbt;
+	struct can_ctrlmode cm;
+	struct req_info req_info;
+	__u8 if_state = 0;
+	int failed = CAN_CONFIG_STAGE_NONE;
+	int up = 0;
+	int i, n = 0;
+
+	if (stage)
+		*stage = CAN_CONFIG_STAGE_NONE;
+
+	if (cfg->mask == 0)
+		return 0;
+
+	memset(&req_info, 0, sizeof(req_info));
+
+	if (cfg->mask & CAN_CONFIG_BITTIMING) {
+		bt = cfg->bittiming;
+		req_info.bittiming = &bt;
+	}
+
+	if (cfg->mask & CAN_CONFIG_DATA_BITTIMING) {
+		dbt = cfg->data_bittiming;
+		req_info.dbittiming = &dbt;
+	}
+
+	if (cfg->mask & (CAN_CONFIG_CTRLMODE | CAN_CONFIG_DATA_BITTIMING)) {
+		memset(&cm, 0, sizeof(cm));
+		if (cfg->mask & CAN_CONFIG_CTRLMODE)
+			cm = cfg->ctrlmode;
+		/* data bittiming implies CAN FD, unless explicitly masked */
+		if ((cfg->mask & CAN_CONFIG_DATA_BITTIMING) &&
+		    !(cm.mask & CAN_CTRLMODE_FD)) {
+			cm.mask |= CAN_CTRLMODE_FD;
+			cm.flags |= CAN_CTRLMODE_FD;
+		}
+		req_info.ctrlmode = &cm;
+	}
+
+	if (cfg->mask & CAN_CONFIG_RESTART_MS) {
+		req_info.restart_ms = cfg->restart_ms;
+		if (cfg->restart_ms == 0)
+			req_info.disable_autorestart = 1;
+	}
+
+	if (h == NULL) {
+		h = tmp = tmp_handle_get();
+		if (h == NULL)
+			return -1;
+	}
+
+	if (cfg->mask & CAN_CONFIG_STATE) {
+		up = cfg->up;
+	} else {
+		unsigned int flags;
+
+		/* restore the admin state the interface had before */
+		if (do_get_nl_link(h, GET_FLAGS, name, 0, &flags) < 0) {
+			failed = CAN_CONFIG_STAGE_QUERY;
+			goto out;
+		}
+		up = !!(flags & IFF_UP);
+	}
+
+	if (up)
+		if_state = IF_UP;
+	else if (cfg->mask & CAN_CONFIG_STATE)
+		if_state = IF_DOWN;
+
+	/*
+	 * The kernel refuses to change can parameters of a running interface,
+	 * so take it down first. Both requests are sent in a single sendmsg,
+	 * the interface is brought up again by the kernel right after the
+	 * parameters have been applied, without another round trip.
+	 */
+	if (cfg->mask & ~CAN_CONFIG_STATE) {
+		if (build_set_req(&e[n++].req, IF_DOWN, name, 0, NULL) < 0) {
+			failed = CAN_CONFIG_STAGE_DOWN;
+			goto out;
+		}
+		if (build_set_req(&e[n++].req, up ? IF_UP : 0, name, 0,
+				  &req_info) < 0) {
+			failed = CAN_CONFIG_STAGE_APPLY;
+			goto out;
+		}
+	} else if (build_set_req(&e[n++].req, if_state, name, 0, NULL) < 0) {
+		failed = CAN_CONFIG_STAGE_APPLY;
+		goto out;
+	}
+
+	for (i = 0; i < n; i++)
+		e[i].req.n.nlmsg_flags |= NLM_F_ACK;
+
+	if (batch_send_chunk(h, e, n) < 0) {
+		failed = n > 1 ? CAN_CONFIG_STAGE_DOWN : CAN_CONFIG_STAGE_APPLY;
+		goto out;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (e[i].err) {
+			failed = (i == 0 && n > 1) ?
+				CAN_CONFIG_STAGE_DOWN : CAN_CONFIG_STAGE_APPLY;
+			nl_perror(h, e[i].err);
+			break;
+		}
+	}
+
+	/* rejected parameters, don't leave the interface down */
+	if (failed == CAN_CONFIG_STAGE_APPLY && n > 1 && up)
+		do_set_nl_link(h, IF_UP, name, 0, NULL);
+
+out:
+	tmp_handle_put(tmp);
+
+	if (stage)
+		*stage = failed;
+
+	return failed == CAN_CONFIG_STAGE_NONE ? 0 : -1;
 }
 
 /**
  * @ingroup extern
- * can_get_bittiming_const - get the current bittimnig constant.
+ * can_apply_config - apply a complete configuration at once
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
+ * @param name name of the can device. This is the netdev name, as ip link shows
+ * in your system. usually it contains prefix "can" and the number of the can
  * line. e.g. "can0"
- * @param btc pointer to the bittiming constant struct.
+ * @param cfg configuration to apply
+ * @param stage pointer to store the stage which failed, may be NULL
  *
- * This one stores the hardware dependent bittiming constant. The
- * can_bittiming_const struct consists:
+ * This applies bittiming, data bittiming, control mode, restart_ms and the
+ * admin state selected by the CAN_CONFIG_* bits in cfg->mask with the
+ * minimal sequence of requests the kernel allows, instead of one transaction
+ * per parameter:
+ *
+ * - if only CAN_CONFIG_STATE is set, a single up or down request is sent
+ * - otherwise the interface is taken down and the parameters plus the admin
+ *   state are applied in a single RTM_NEWLINK right after it. Both requests
+ *   go out in one sendmsg to keep the time the bus is offline minimal.
+ *
+ * If CAN_CONFIG_STATE is not set, the interface is brought back into the
+ * admin state it had before. If the kernel rejects the parameters, the
+ * interface is brought up again with its old parameters if it is meant to
+ * be up. If CAN_CONFIG_DATA_BITTIMING is set, CAN FD mode is enabled unless
+ * cfg->ctrlmode masks CAN_CTRLMODE_FD itself.
  *
  * @code
- * struct can_bittiming_const {
- *	char name[16];
- *	__u32 tseg1_min;
- *	__u32 tseg1_max;
- *	__u32 tseg2_min;
- *	__u32 tseg2_max;
- *	__u32 sjw_max;
- *	__u32 brp_min;
- *	__u32 brp_max;
- *	__u32 brp_inc;
- *	};
+ * struct can_config cfg;
+ * int stage;
+ *
+ * memset(&cfg, 0, sizeof(cfg));
+ * cfg.mask = CAN_CONFIG_BITTIMING | CAN_CONFIG_RESTART_MS | CAN_CONFIG_STATE;
+ * cfg.bittiming.bitrate = 500000;
+ * cfg.restart_ms = 100;
+ * cfg.up = 1;
+ * if (can_apply_config("can0", &cfg, &stage) < 0)
+ *	fprintf(stderr, "failed in stage %d\n", stage);
  * @endcode
  *
- * The information in this struct is used to calculate the bus bit timing
- * automatically.
+ * On failure, stage is set to one of the CAN_CONFIG_STAGE_* values.
  *
  * @return 0 if success
  * @return -1 if failed
  */
-int can_get_bittiming_const(const char *name, struct can_bittiming_const *btc)
+int can_apply_config(const char *name, const struct can_config *cfg,
+		int *stage)
 {
-	return get_link(name, GET_BITTIMING_CONST, btc);
+	return can_handle_apply_config(NULL, name, cfg, stage);
 }
 
 /**
- * @ingroup extern
- * can_get_data_bittiming_const - get the current bittimnig constant.
+ * @ingroup intern
+ * @brief switch_wait - wait for the acks of a bittiming switch and the link
+ * coming back
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param dbtc pointer to the bittiming constant struct.
+ * @param h handle to a priorly opened netlink socket, subscribed to
+ * RTNLGRP_LINK
+ * @param e the down and the set+up request, already sent
+ * @param ifindex interface index of the can device
+ * @param deadline_us CLOCK_MONOTONIC time to give up at
+ * @param running_us pointer to store the time IFF_RUNNING was reported
  *
- * This one stores the hardware dependent bittiming constant. The
- * can_bittiming_const struct consists:
+ * @return 0 if both requests were acked and the link reported IFF_RUNNING
+ * @return -1 if failed
+ */
+static int switch_wait(struct can_handle *h, struct batch_entry *e,
+		       int ifindex, __u64 deadline_us, __u64 *running_us)
+{
+	struct rx_buf tmp, *rx;
+	struct nlmsghdr *nl_msg;
+	ssize_t msglen;
+	int acked = 0;
+	int running = 0;
+	int lost = 0;
+	int ret = 0;
+	int i;
+
+	rx = rx_begin(h, &tmp);
+	while (acked < 2 || !running) {
+		struct pollfd pfd = {
+			.fd = h->fd,
+			.events = POLLIN,
+		};
+		__u64 now = monotonic_us();
+		size_t u_msglen;
+
+		/* the notification about IFF_RUNNING may have been dropped */
+		if (lost && acked == 2) {
+			unsigned int flags;
+
+			lost = 0;
+			if (do_get_nl_link(h, GET_FLAGS, NULL, ifindex,
+					   &flags) < 0) {
+				ret = -1;
+				break;
+			}
+			if (flags & IFF_RUNNING) {
+				*running_us = monotonic_us();
+				running = 1;
+				break;
+			}
+		}
+
+		if (now >= deadline_us) {
+			errno = ETIMEDOUT;
+			ret = -1;
+			break;
+		}
+
+		if (poll(&pfd, 1, (deadline_us - now + 999) / 1000) < 0) {
+			if (errno == EINTR)
+				continue;
+			ret = -1;
+			break;
+		}
+
+		msglen = rx_recv(h->fd, rx, MSG_DONTWAIT);
+		if (msglen < 0) {
+			if (errno == EINTR || errno == EAGAIN ||
+			    errno == EWOULDBLOCK)
+				continue;
+			/* link notifications overran the socket */
+			if (errno == ENOBUFS) {
+				rx_overrun(h);
+				lost = 1;
+				continue;
+			}
+			ret = -1;
+			break;
+		}
+
+		u_msglen = (size_t) msglen;
+		for (nl_msg = (struct nlmsghdr *)rx->buf;
+		     NLMSG_OK(nl_msg, u_msglen);
+		     nl_msg = NLMSG_NEXT(nl_msg, u_msglen)) {
+			struct ifinfomsg *ifi = NLMSG_DATA(nl_msg);
+
+			for (i = 0; i < 2; i++)
+				if (e[i].err == 1 &&
+				    e[i].req.n.nlmsg_seq == nl_msg->nlmsg_seq)
+					break;
+
+			if (i < 2 && nl_msg->nlmsg_type == NLMSG_ERROR) {
+				e[i].err = ack_error(h, nl_msg);
+				acked++;
+				if (e[i].err) {
+					errno = -e[i].err;
+					ret = -1;
+					goto out;
+				}
+				continue;
+			}
+
+			async_process_msg(h, nl_msg);
+			if (nl_msg->nlmsg_seq != 0)
+				continue;
+
+			/*
+			 * Everything reported after the ack of the down
+			 * request belongs to the set+up request.
+			 */
+			if (nl_msg->nlmsg_type == RTM_NEWLINK && e[0].err == 0 &&
+			    !running && ifi->ifi_index == ifindex &&
+			    (ifi->ifi_flags & IFF_RUNNING)) {
+				*running_us = monotonic_us();
+				running = 1;
+			}
+		}
+	}
+
+out:
+	rx_end(h, rx);
+
+	return ret;
+}
+
+/**
+ * @ingroup extern
+ * can_handle_switch_bittiming - can_switch_bittiming using a netlink handle
  *
- * @code
- * struct can_bittiming_const {
- *	char name[16];
- *	__u32 tseg1_min;
- *	__u32 tseg1_max;
- *	__u32 tseg2_min;
- *	__u32 tseg2_max;
- *	__u32 sjw_max;
- *	__u32 brp_min;
- *	__u32 brp_max;
- *	__u32 brp_inc;
- *	};
- * @endcode
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
  *
- * The information in this struct is used to calculate the bus bit timing
- * automatically.
+ * Please see can_switch_bittiming for the other parameters and more
+ * information.
  *
  * @return 0 if success
  * @return -1 if failed
  */
-int can_get_data_bittiming_const(const char *name, struct can_bittiming_const *dbtc)
+int can_handle_switch_bittiming(struct can_handle *h, const char *name,
+		struct can_bittiming *bt, struct can_bittiming *dbt,
+		int timeout_ms, __u32 *offline_us)
 {
-	return get_link(name, GET_BITTIMING_CONST, dbtc);
+	struct can_handle *tmp = NULL;
+	struct batch_entry e[2];
+	struct can_ctrlmode cm = {
+		.mask = CAN_CTRLMODE_FD,
+		.flags = CAN_CTRLMODE_FD,
+	};
+	struct req_info req_info = {
+		.bittiming = bt,
+		.dbittiming = dbt,
+		.ctrlmode = dbt ? &cm : NULL,
+	};
+	struct sockaddr_nl nladdr = {
+		.nl_family = AF_NETLINK,
+	};
+	struct iovec iov[2];
+	struct msghdr msg = {
+		.msg_name = &nladdr,
+		.msg_namelen = sizeof(nladdr),
+		.msg_iov = iov,
+		.msg_iovlen = 2,
+	};
+	__u64 start_us, running_us = 0;
+	int ifindex;
+	int err = -1;
+	int i;
+
+	if (h == NULL) {
+		h = tmp = tmp_handle_get();
+		if (h == NULL)
+			return -1;
+	}
+
+	/* the notifications only tell the link by its index */
+	ifindex = can_handle_name_to_index(h, name);
+	if (ifindex < 0)
+		goto out_close;
+
+	/* build everything before the bus goes offline */
+	if (build_set_req(&e[0].req, IF_DOWN, NULL, ifindex, NULL) < 0 ||
+	    build_set_req(&e[1].req, IF_UP, NULL, ifindex, &req_info) < 0)
+		goto out_close;
+
+	e[0].req.n.nlmsg_flags |= NLM_F_ACK;
+	e[1].req.n.nlmsg_flags |= NLM_F_ACK;
+	e[0].err = e[1].err = 1;
+
+	if (handle_subscribe(h, 1) < 0)
+		goto out_close;
+
+	for (i = 0; i < 2; i++) {
+		e[i].req.n.nlmsg_seq = next_seq(h);
+		iov[i].iov_base = &e[i].req;
+		iov[i].iov_len = NLMSG_ALIGN(e[i].req.n.nlmsg_len);
+	}
+
+	start_us = monotonic_us();
+	if (sendmsg(h->fd, &msg, 0) < 0) {
+		perror("Cannot talk to rtnetlink");
+		goto out_unsubscribe;
+	}
+	coalesce_invalidate(h);
+
+	err = switch_wait(h, e, ifindex,
+			  start_us + (__u64)timeout_ms * 1000, &running_us);
+	if (err < 0) {
+		perror("Cannot switch bittiming");
+		/* rejected bittiming, don't leave the interface down */
+		if (e[0].err == 0 && e[1].err < 0)
+			do_set_nl_link(h, IF_UP, NULL, ifindex, NULL);
+	} else if (offline_us) {
+		*offline_us = running_us - start_us;
+	}
+
+out_unsubscribe:
+	handle_subscribe(h, 0);
+out_close:
+	tmp_handle_put(tmp);
+
+	return err;
 }
 
 /**
  * @ingroup extern
- * can_get_berr_counter - get the tx/rx error counter.
+ * can_switch_bittiming - switch the bittiming of a running interface
  *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
+ * @param name name of the can device. This is the netdev name, as ip link shows
+ * in your system. usually it contains prefix "can" and the number of the can
  * line. e.g. "can0"
- * @param bc pointer to the error counter struct..
+ * @param bt pointer to the new nominal can_bittiming struct
+ * @param dbt pointer to the new data can_bittiming struct, or NULL for
+ * classic CAN
+ * @param timeout_ms time to wait for the interface to come back
+ * @param offline_us pointer to store the measured offline time in
+ * microseconds, may be NULL
  *
- * This one gets the current rx/tx error counter from the hardware.
+ * The kernel only accepts a new bittiming while the interface is down. This
+ * one builds the down request and the combined bittiming + up request in
+ * advance and sends both in a single sendmsg, then waits for the link
+ * notification reporting IFF_RUNNING again. The time from sending the down
+ * request until that notification is stored in offline_us, so the offline
+ * window can be tracked. If dbt is given, CAN FD mode is enabled as well.
  *
- * @code
- * struct can_berr_counter {
- *	__u16 txerr;
- *	__u16 rxerr;
- *	};
- * @endcode
+ * If the kernel rejects the bittiming, the interface is brought up again
+ * with its old bittiming.
  *
  * @return 0 if success
- * @return -1 if failed
+ * @return -1 if failed, errno is ETIMEDOUT if the interface did not report
+ * IFF_RUNNING within timeout_ms
  */
-int can_get_berr_counter(const char *name, struct can_berr_counter *bc)
+int can_switch_bittiming(const char *name, struct can_bittiming *bt,
+		struct can_bittiming *dbt, int timeout_ms, __u32 *offline_us)
 {
-	return get_link(name, GET_BERR_COUNTER, bc);
+	return can_handle_switch_bittiming(NULL, name, bt, dbt, timeout_ms,
+					   offline_us);
 }
 
 /**
  * @ingroup extern
- * can_get_device_stats - get the can_device_stats.
- *
- * @param name name of the can device. This is the netdev name, as ifconfig -a shows
- * in your system. usually it contains prefix "can" and the numer of the can
- * line. e.g. "can0"
- * @param bc pointer to the error counter struct..
+ * can_handle_switch_bitrate - can_switch_bitrate using a netlink handle
  *
- * This one gets the current can_device_stats.
+ * @param h netlink handle as returned by can_handle_open, or NULL to use a
+ * temporary one for this call only
  *
- * Please see struct can_device_stats for more information.
+ * Please see can_switch_bitrate for the other parameters and more
+ * information.
  *
  * @return 0 if success
  * @return -1 if failed
  */
-int can_get_device_stats(const char *name, struct can_device_stats *cds)
+int can_handle_switch_bitrate(struct can_handle *h, const char *name,
+		__u32 bitrate, __u32 dbitrate, int timeout_ms,
+		__u32 *offline_us)
 {
-	return get_link(name, GET_XSTATS, cds);
+	struct can_bittiming bt, dbt;
+
+	memset(&bt, 0, sizeof(bt));
+	bt.bitrate = bitrate;
+
+	memset(&dbt, 0, sizeof(dbt));
+	dbt.bitrate = dbitrate;
+
+	return can_handle_switch_bittiming(h, name, &bt,
+					   dbitrate ? &dbt : NULL,
+					   timeout_ms, offline_us);
 }
 
 /**
  * @ingroup extern
- * can_get_link_statistics - get RX/TX statistics (64 bits version)
+ * can_switch_bitrate - switch the bitrate of a running interface
  *
  * @param name name of the can device. This is the netdev name, as ip link shows
  * in your system. usually it contains prefix "can" and the number of the can
  * line. e.g. "can0"
- * @param rls pointer to the rtnl_link_stats64 struct which is from if_link.h.
- *
- * This one gets the current rtnl_link_stats64. Compares to the rtnl_link_stats,
- * The rtnl_link_stats64 is introduced since linux kernel 2.6. After that the
- * rtnl_link_stats is synchronous with struct rtnl_link_stats64 by truncating
- * each member from 64 bits to 32 bits. actually, the struct rtnl_link_stats
- * is kept for compatibility.
+ * @param bitrate new nominal bitrate of the can bus
+ * @param dbitrate new data bitrate for CAN FD, or 0 for classic CAN
+ * @param timeout_ms time to wait for the interface to come back
+ * @param offline_us pointer to store the measured offline time in
+ * microseconds, may be NULL
  *
- * Please see struct rtnl_link_stats64 (/usr/include/linux/if_link.h) for more
- * information.
+ * This one is similar to can_switch_bittiming, only the exact bit timing is
+ * calculated by the kernel as with can_set_bitrate.
  *
  * @return 0 if success
  * @return -1 if failed
  */
-int can_get_link_stats(const char *name, struct rtnl_link_stats64 *rls)
+int can_switch_bitrate(const char *name, __u32 bitrate, __u32 dbitrate,
+		int timeout_ms, __u32 *offline_us)
 {
-	return get_link(name, GET_LINK_STATS, rls);
+	return can_handle_switch_bitrate(NULL, name, bitrate, dbitrate,
+					 timeout_ms, offline_us);
 }